@@ -0,0 +1,35 @@
+#!/bin/sh
+# Pomiar całej ścieżki klienta: osobne wywołanie na komendę (kolejka komunikatów)
+# a tryb wsadowy BATCH (jedna sesja, pierścień negocjowany przez kolejkę).
+# Uruchomienie (z katalogu z plikiem wykonywalnym): bench/batch_bench.sh ./scheduler [komendy]
+# Harmonogram nie może działać - skrypt uruchamia własny serwer bez limitu zapytań na UID.
+BINARY=${1:-./scheduler}
+COUNT=${2:-2000}
+BATCH_FILE=$(mktemp)
+
+now_ns() {
+    date +%s%N
+}
+
+SCHEDULER_RATE_LIMIT=0 "$BINARY" DISPLAY > /dev/null
+sleep 0.5
+for i in $(seq 1 "$COUNT"); do
+    echo "RELATIVE 0 1 0 0 0 /bin/true --tag bench"
+done > "$BATCH_FILE"
+
+start=$(now_ns)
+for i in $(seq 1 "$COUNT"); do
+    "$BINARY" RELATIVE 0 1 0 0 0 /bin/true --tag bench
+done
+end=$(now_ns)
+echo "osobne wywołania: $((COUNT * 1000000000 / (end - start))) komend/s"
+"$BINARY" CANCEL TAG bench > /dev/null
+
+start=$(now_ns)
+"$BINARY" BATCH < "$BATCH_FILE"
+end=$(now_ns)
+echo "BATCH: $((COUNT * 1000000000 / (end - start))) komend/s"
+"$BINARY" CANCEL TAG bench > /dev/null
+
+"$BINARY" SHUTDOWN
+rm -f "$BATCH_FILE"
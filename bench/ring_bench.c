@@ -0,0 +1,208 @@
+// Porównanie transportu zapytań: pierścień w pamięci współdzielonej a kolejka komunikatów.
+// Mierzy sam transport (bez obsługi zapytań przez harmonogram), odbiorca naśladuje serwer:
+// kolejka - odpowiedź przez mq_open/mq_send/mq_close na kolejkę klienta, pierścień - slot odpowiedzi.
+//
+// Budowa (z katalogu głównego):
+//   gcc -O2 -I. bench/ring_bench.c shm_ring.c -o ring_bench -lrt -lpthread
+// Uruchomienie: ./ring_bench [producenci] [zapytania_na_producenta]
+// Harmonogram nie może działać - pierścień używa tej samej nazwy co serwer.
+#include "shm_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mqueue.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#define BENCH_QUEUE_NAME "/scheduler_bench_queue"
+#define BENCH_MAX_PRODUCERS 64
+
+struct bench_producer_t {
+    int id;
+    int requests;
+    int round_trip;
+};
+
+struct shm_ring_t *bench_ring = NULL;
+int bench_producers = 4;
+int bench_requests = 100000;
+
+// Czas w sekundach (zegar monotoniczny)
+static double bench_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Odbiorca pierścienia - potwierdza zapytania z przydzielonym slotem
+static void *ring_consumer(void *arg) {
+    struct query_t query;
+    while (shm_ring_pop(bench_ring, &query) == 0) {
+        if (query.command == SHUTDOWN) {
+            break;
+        }
+        if (query.reply_slot >= 0) {
+            struct reply_t reply;
+            memset(&reply, 0, sizeof(struct reply_t));
+            shm_ring_reply(bench_ring, query.reply_slot, &reply, NULL);
+        }
+    }
+    return NULL;
+}
+
+// Producent pierścienia
+static void *ring_producer(void *arg) {
+    struct bench_producer_t *producer = arg;
+    int slot = producer->round_trip ? shm_ring_acquire_slot(bench_ring, getpid()) : -1;
+    struct query_t query;
+    memset(&query, 0, sizeof(struct query_t));
+    query.command = RELATIVE;
+    query.reply_slot = slot;
+    struct reply_t reply;
+    for (int i = 0; i < producer->requests; i++) {
+        query.task_id = i;
+        if (shm_ring_push(bench_ring, &query, NULL) != 0) {
+            break;
+        }
+        if (slot >= 0 && shm_ring_receive(bench_ring, slot, &reply, NULL) != 0) {
+            break;
+        }
+    }
+    shm_ring_release_slot(bench_ring, slot);
+    return NULL;
+}
+
+// Odbiorca kolejki - odpowiada tak jak serwer, otwierając kolejkę klienta dla każdej odpowiedzi
+static void *mq_consumer(void *arg) {
+    mqd_t queue_id = *(mqd_t *)arg;
+    struct query_t query;
+    while (mq_receive(queue_id, (char *)&query, sizeof(struct query_t), NULL) != -1) {
+        if (query.command == SHUTDOWN) {
+            break;
+        }
+        if (query.reply_name[0] != '\0') {
+            struct reply_t reply;
+            memset(&reply, 0, sizeof(struct reply_t));
+            mqd_t reply_queue = mq_open(query.reply_name, O_WRONLY);
+            if (reply_queue != -1) {
+                mq_send(reply_queue, (const char *)&reply, sizeof(struct reply_t), 0);
+                mq_close(reply_queue);
+            }
+        }
+    }
+    return NULL;
+}
+
+// Producent kolejki
+static void *mq_producer(void *arg) {
+    struct bench_producer_t *producer = arg;
+    mqd_t queue_id = mq_open(BENCH_QUEUE_NAME, O_WRONLY);
+    struct query_t query;
+    memset(&query, 0, sizeof(struct query_t));
+    query.command = RELATIVE;
+    query.reply_slot = -1;
+    mqd_t reply_id = -1;
+    if (producer->round_trip) {
+        sprintf(query.reply_name, "/scheduler_bench_reply_%d_%d", getpid(), producer->id);
+        struct mq_attr reply_attr;
+        memset(&reply_attr, 0, sizeof(struct mq_attr));
+        reply_attr.mq_maxmsg = INITIAL_CAPACITY;
+        reply_attr.mq_msgsize = sizeof(struct reply_t);
+        mq_unlink(query.reply_name);
+        reply_id = mq_open(query.reply_name, O_RDONLY | O_CREAT | O_EXCL, 0666, &reply_attr);
+    }
+    struct reply_t reply;
+    for (int i = 0; i < producer->requests && queue_id != -1; i++) {
+        query.task_id = i;
+        if (mq_send(queue_id, (const char *)&query, sizeof(struct query_t), 0) == -1) {
+            break;
+        }
+        if (reply_id != -1 && mq_receive(reply_id, (char *)&reply, sizeof(struct reply_t), NULL) == -1) {
+            break;
+        }
+    }
+    if (reply_id != -1) {
+        mq_close(reply_id);
+        mq_unlink(query.reply_name);
+    }
+    mq_close(queue_id);
+    return NULL;
+}
+
+// Jeden przebieg: producenci równolegle, wynik w zapytaniach na sekundę
+static double bench_run(void *(*producer_main)(void *), int round_trip) {
+    pthread_t threads[BENCH_MAX_PRODUCERS];
+    struct bench_producer_t producers[BENCH_MAX_PRODUCERS];
+    double start = bench_now();
+    for (int i = 0; i < bench_producers; i++) {
+        producers[i].id = i;
+        producers[i].requests = bench_requests;
+        producers[i].round_trip = round_trip;
+        pthread_create(&threads[i], NULL, producer_main, &producers[i]);
+    }
+    for (int i = 0; i < bench_producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return (double)bench_producers * bench_requests / (bench_now() - start);
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2) {
+        bench_producers = atoi(argv[1]);
+    }
+    if (argc >= 3) {
+        bench_requests = atoi(argv[2]);
+    }
+    if (bench_producers <= 0 || bench_producers > BENCH_MAX_PRODUCERS || bench_requests <= 0) {
+        printf("Użycie: %s [producenci 1-%d] [zapytania_na_producenta]\n", argv[0], BENCH_MAX_PRODUCERS);
+        return 1;
+    }
+    struct shm_ring_t *existing = shm_ring_attach();
+    if (existing != NULL) {
+        shm_ring_detach(existing);
+        printf("Harmonogram działa - zatrzymaj go przed pomiarem.\n");
+        return 1;
+    }
+
+    // Kolejka o tych samych parametrach co kolejka serwera
+    struct mq_attr queue_attr;
+    memset(&queue_attr, 0, sizeof(struct mq_attr));
+    queue_attr.mq_maxmsg = INITIAL_CAPACITY;
+    queue_attr.mq_msgsize = sizeof(struct query_t);
+    mq_unlink(BENCH_QUEUE_NAME);
+    mqd_t queue_id = mq_open(BENCH_QUEUE_NAME, O_RDWR | O_CREAT | O_EXCL, 0666, &queue_attr);
+    bench_ring = shm_ring_create();
+    if (queue_id == -1 || bench_ring == NULL) {
+        printf("Błąd tworzenia kolejki lub pierścienia!\n");
+        return 1;
+    }
+
+    struct query_t stop;
+    memset(&stop, 0, sizeof(struct query_t));
+    stop.command = SHUTDOWN;
+    stop.reply_slot = -1;
+    const char *modes[] = { "wysyłanie bez odpowiedzi", "zapytanie z odpowiedzią" };
+    printf("Producenci: %d, zapytania na producenta: %d\n", bench_producers, bench_requests);
+    for (int round_trip = 0; round_trip <= 1; round_trip++) {
+        pthread_t consumer;
+        pthread_create(&consumer, NULL, mq_consumer, &queue_id);
+        double mq_rate = bench_run(mq_producer, round_trip);
+        mq_send(queue_id, (const char *)&stop, sizeof(struct query_t), 0);
+        pthread_join(consumer, NULL);
+
+        pthread_create(&consumer, NULL, ring_consumer, NULL);
+        double ring_rate = bench_run(ring_producer, round_trip);
+        shm_ring_push(bench_ring, &stop, NULL);
+        pthread_join(consumer, NULL);
+
+        printf("%s: kolejka %.0f/s, pierścień %.0f/s (x%.1f)\n", modes[round_trip], mq_rate, ring_rate,
+               ring_rate / mq_rate);
+    }
+
+    shm_ring_destroy(bench_ring);
+    mq_close(queue_id);
+    mq_unlink(BENCH_QUEUE_NAME);
+    return 0;
+}
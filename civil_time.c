@@ -0,0 +1,182 @@
+#include "civil_time.h"
+#include <pthread.h>
+
+// Okna strefy wokół bieżącej chwili - odświeżane tylko po przekroczeniu granicy przejścia;
+// zastępowane cyklicznie
+static struct civil_zone_t zone_cache[CIVIL_ZONE_SLOTS];
+static int zone_count = 0;
+static int zone_next = 0;
+static pthread_rwlock_t zone_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+// Liczba dni od 1970-01-01 dla daty kalendarza gregoriańskiego (miesiąc 1-12)
+static long days_from_civil(long year, long month, long day) {
+    year -= month <= 2;
+    long era = (year >= 0 ? year : year - 399) / 400;
+    long year_of_era = year - era * 400;
+    long day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+// Data kalendarza gregoriańskiego dla liczby dni od 1970-01-01
+static void civil_from_days(long days, long *year, long *month, long *day) {
+    days += 719468;
+    long era = (days >= 0 ? days : days - 146096) / 146097;
+    long day_of_era = days - era * 146097;
+    long year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    long day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    long month_index = (5 * day_of_year + 2) / 153;
+    *day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    *month = month_index < 10 ? month_index + 3 : month_index - 9;
+    *year = year_of_era + era * 400 + (*month <= 2);
+}
+
+// Porównanie przesunięcia strefy w chwili t z oknem
+static int same_zone(time_t t, const struct tm *reference) {
+    struct tm probe;
+    localtime_r(&t, &probe);
+    return probe.tm_gmtoff == reference->tm_gmtoff && probe.tm_isdst == reference->tm_isdst;
+}
+
+// Wyszukanie binarne przejścia w przedziale (low, high]; zwraca pierwszą sekundę po zmianie
+static time_t find_transition(time_t low, time_t high, const struct tm *reference) {
+    int low_inside = same_zone(low, reference);
+    while (high - low > 1) {
+        time_t middle = low + (high - low) / 2;
+        if (same_zone(middle, reference) == low_inside) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return high;
+}
+
+// Wyznaczenie okna wokół chwili t na podstawie tzdata (wywoływane pod blokadą do zapisu)
+static void refresh_zone(time_t t, struct civil_zone_t *zone) {
+    tzset();
+    struct tm reference;
+    localtime_r(&t, &reference);
+
+    // Przejścia są odległe o więcej niż krok próbkowania
+    time_t end = t;
+    int probes = 0;
+    while (probes < CIVIL_WINDOW_PROBES && same_zone(end + CIVIL_PROBE_STEP, &reference)) {
+        end += CIVIL_PROBE_STEP;
+        probes++;
+    }
+    if (probes < CIVIL_WINDOW_PROBES) {
+        end = find_transition(end, end + CIVIL_PROBE_STEP, &reference);
+    }
+
+    time_t start = t;
+    probes = 0;
+    while (probes < CIVIL_WINDOW_PROBES && same_zone(start - CIVIL_PROBE_STEP, &reference)) {
+        start -= CIVIL_PROBE_STEP;
+        probes++;
+    }
+    if (probes < CIVIL_WINDOW_PROBES) {
+        start = find_transition(start - CIVIL_PROBE_STEP, start, &reference);
+    }
+
+    zone->window_start = start;
+    zone->window_end = end;
+    zone->utc_offset = reference.tm_gmtoff;
+    zone->is_dst = reference.tm_isdst;
+    zone->zone = reference.tm_zone;
+}
+
+// Wyszukanie zapamiętanego okna zawierającego chwilę t (wywoływane pod blokadą)
+static int find_zone(time_t t, struct civil_zone_t *zone) {
+    for (int i = 0; i < zone_count; i++) {
+        if (t >= zone_cache[i].window_start && t < zone_cache[i].window_end) {
+            *zone = zone_cache[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Pobranie okna zawierającego chwilę t; 0 gdy chwila jest zbyt odległa od bieżącej,
+// by jej okno warto było zapamiętać
+static int lookup_zone(time_t t, struct civil_zone_t *zone) {
+    pthread_rwlock_rdlock(&zone_lock);
+    int found = find_zone(t, zone);
+    pthread_rwlock_unlock(&zone_lock);
+    if (found) {
+        return 1;
+    }
+    time_t now = time(NULL);
+    if (t < now - CIVIL_CACHE_RANGE || t > now + CIVIL_CACHE_RANGE) {
+        return 0;
+    }
+
+    pthread_rwlock_wrlock(&zone_lock);
+    if (!find_zone(t, zone)) {
+        refresh_zone(t, &zone_cache[zone_next]);
+        *zone = zone_cache[zone_next];
+        zone_next = (zone_next + 1) % CIVIL_ZONE_SLOTS;
+        if (zone_count < CIVIL_ZONE_SLOTS) {
+            zone_count++;
+        }
+    }
+    pthread_rwlock_unlock(&zone_lock);
+    return 1;
+}
+
+// Odpowiednik localtime_r liczony arytmetycznie w obrębie okna strefy
+struct tm *civil_localtime(const time_t *timer, struct tm *result) {
+    struct civil_zone_t zone;
+    if (!lookup_zone(*timer, &zone)) {
+        return localtime_r(timer, result);
+    }
+
+    long local = *timer + zone.utc_offset;
+    long days = local / 86400;
+    long seconds = local % 86400;
+    if (seconds < 0) {
+        seconds += 86400;
+        days--;
+    }
+    long year, month, day;
+    civil_from_days(days, &year, &month, &day);
+
+    result->tm_year = year - 1900;
+    result->tm_mon = month - 1;
+    result->tm_mday = day;
+    result->tm_hour = seconds / 3600;
+    result->tm_min = seconds / 60 % 60;
+    result->tm_sec = seconds % 60;
+    result->tm_wday = ((days % 7) + 11) % 7;
+    result->tm_yday = days - days_from_civil(year, 1, 1);
+    result->tm_isdst = zone.is_dst;
+    result->tm_gmtoff = zone.utc_offset;
+    result->tm_zone = zone.zone;
+    return result;
+}
+
+// Odpowiednik mktime; przesunięcie przyjmowane z okna bieżącej chwili, poza nim
+// (lub na jego granicy) korzysta z tzdata
+time_t civil_mktime(struct tm *time_struct) {
+    long year = time_struct->tm_year + 1900L + time_struct->tm_mon / 12;
+    long month = time_struct->tm_mon % 12;
+    if (month < 0) {
+        month += 12;
+        year--;
+    }
+    long local = (days_from_civil(year, month + 1, 1) + time_struct->tm_mday - 1) * 86400L +
+                 time_struct->tm_hour * 3600L + time_struct->tm_min * 60L + time_struct->tm_sec;
+
+    struct civil_zone_t zone;
+    time_t now = time(NULL);
+    lookup_zone(now, &zone);
+
+    time_t result = local - zone.utc_offset;
+    // Czas lokalny bliski przejściu może być niejednoznaczny lub nieistniejący
+    if (result - zone.window_start < 86400 || zone.window_end - result <= 86400 ||
+        (time_struct->tm_isdst >= 0 && time_struct->tm_isdst != zone.is_dst)) {
+        return mktime(time_struct);
+    }
+    civil_localtime(&result, time_struct);
+    return result;
+}
@@ -0,0 +1,25 @@
+#ifndef PROJECT2_CIVIL_TIME_H
+#define PROJECT2_CIVIL_TIME_H
+
+#include <time.h>
+
+#define CIVIL_PROBE_STEP 86400
+#define CIVIL_WINDOW_PROBES 32
+// Liczba zapamiętanych okien (bieżące, poprzednie, następne i jedno zapasowe)
+#define CIVIL_ZONE_SLOTS 4
+// Chwile dalej od bieżącej niż zasięg próbkowania nie zastępują okien w pamięci
+#define CIVIL_CACHE_RANGE (CIVIL_PROBE_STEP * CIVIL_WINDOW_PROBES)
+
+// Okno czasu o stałym przesunięciu względem UTC (między przejściami czasu letniego)
+struct civil_zone_t{
+    time_t window_start;
+    time_t window_end;
+    long utc_offset;
+    int is_dst;
+    const char *zone;
+};
+
+struct tm *civil_localtime(const time_t *timer, struct tm *result);
+time_t civil_mktime(struct tm *time_struct);
+
+#endif
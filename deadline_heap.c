@@ -0,0 +1,112 @@
+#include "deadline_heap.h"
+#include <stdlib.h>
+
+// Przesunięcie elementu w górę kopca
+static void sift_up(struct deadline_heap_t *heap, int index) {
+    struct deadline_t entry = heap->entries[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (heap->entries[parent].when <= entry.when) {
+            break;
+        }
+        heap->entries[index] = heap->entries[parent];
+        index = parent;
+    }
+    heap->entries[index] = entry;
+}
+
+// Przesunięcie elementu w dół kopca
+static void sift_down(struct deadline_heap_t *heap, int index) {
+    struct deadline_t entry = heap->entries[index];
+    while (1) {
+        int child = 2 * index + 1;
+        if (child >= heap->size) {
+            break;
+        }
+        if (child + 1 < heap->size && heap->entries[child + 1].when < heap->entries[child].when) {
+            child++;
+        }
+        if (entry.when <= heap->entries[child].when) {
+            break;
+        }
+        heap->entries[index] = heap->entries[child];
+        index = child;
+    }
+    heap->entries[index] = entry;
+}
+
+// Inicjalizacja kopca
+int init_deadline_heap(struct deadline_heap_t *heap, int capacity) {
+    if (heap == NULL || capacity <= 0) {
+        return -1;
+    }
+    heap->size = 0;
+    heap->capacity = capacity;
+    heap->entries = (struct deadline_t *)calloc(heap->capacity, sizeof(struct deadline_t));
+    if (heap->entries == NULL) {
+        return -2;
+    }
+    return 0;
+}
+
+// Zapewnienie miejsca na co najmniej capacity terminów
+int reserve_deadline_heap(struct deadline_heap_t *heap, int capacity) {
+    if (heap == NULL || heap->entries == NULL) {
+        return -1;
+    }
+    if (capacity <= heap->capacity) {
+        return 0;
+    }
+    struct deadline_t *new_entries = (struct deadline_t *)realloc(heap->entries, capacity * sizeof(struct deadline_t));
+    if (new_entries == NULL) {
+        return -2;
+    }
+    heap->entries = new_entries;
+    heap->capacity = capacity;
+    return 0;
+}
+
+// Zwalnianie pamięci kopca
+void free_deadline_heap(struct deadline_heap_t *heap) {
+    if (heap == NULL) {
+        return;
+    }
+    free(heap->entries);
+    heap->entries = NULL;
+    heap->size = 0;
+    heap->capacity = 0;
+}
+
+// Dodanie terminu
+int deadline_heap_push(struct deadline_heap_t *heap, struct deadline_t entry) {
+    if (heap->size >= heap->capacity) {
+        if (reserve_deadline_heap(heap, heap->capacity * 2) != 0) {
+            return -1;
+        }
+    }
+    heap->entries[heap->size] = entry;
+    sift_up(heap, heap->size);
+    heap->size++;
+    return 0;
+}
+
+// Pobranie najwcześniejszego terminu
+int deadline_heap_pop(struct deadline_heap_t *heap, struct deadline_t *entry) {
+    if (heap->size == 0) {
+        return -1;
+    }
+    *entry = heap->entries[0];
+    heap->size--;
+    if (heap->size > 0) {
+        heap->entries[0] = heap->entries[heap->size];
+        sift_down(heap, 0);
+    }
+    return 0;
+}
+
+// Budowa kopca z nieuporządkowanej tablicy w czasie O(n)
+void deadline_heap_build(struct deadline_heap_t *heap) {
+    for (int i = heap->size / 2 - 1; i >= 0; i--) {
+        sift_down(heap, i);
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef PROJECT2_DEADLINE_HEAP_H
+#define PROJECT2_DEADLINE_HEAP_H
+
+#include <time.h>
+#include <sys/types.h>
+
+// Rodzaj terminu
+enum deadline_kind_t {
+    DEADLINE_TASK,
+    DEADLINE_TERMINATE,
+    DEADLINE_KILL
+};
+
+// Termin uruchomienia zadania lub limitu czasu jego instancji
+struct deadline_t{
+    time_t when;
+    int task_id;
+    enum deadline_kind_t kind;
+    pid_t pid;
+    unsigned long instance;
+};
+
+// Kopiec minimalny terminów
+struct deadline_heap_t{
+    struct deadline_t *entries;
+    int size;
+    int capacity;
+};
+
+int init_deadline_heap(struct deadline_heap_t *heap, int capacity);
+int reserve_deadline_heap(struct deadline_heap_t *heap, int capacity);
+void free_deadline_heap(struct deadline_heap_t *heap);
+
+int deadline_heap_push(struct deadline_heap_t *heap, struct deadline_t entry);
+int deadline_heap_pop(struct deadline_heap_t *heap, struct deadline_t *entry);
+void deadline_heap_build(struct deadline_heap_t *heap);
+
+#endif
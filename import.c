@@ -0,0 +1,193 @@
+#include "import.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Parsowanie jednej linii w formacie wiersza poleceń: KOMENDA yyyy dd hh mm ss plik
+// Zwraca 1 dla zadania, 0 dla pustej linii lub komentarza, -1 dla błędnej linii
+static int import_parse_line(const char *line, size_t length, time_t cur_time, struct task_t *task) {
+    char buffer[IMPORT_LINE_LENGTH];
+    if (length >= sizeof(buffer)) {
+        return -1;
+    }
+    memcpy(buffer, line, length);
+    buffer[length] = '\0';
+
+    char *argv[IMPORT_MAX_TOKENS];
+    int argc = 0;
+    argv[argc++] = "scheduler";
+    char *save_ptr = NULL;
+    char *token = strtok_r(buffer, " \t\r", &save_ptr);
+    if (token == NULL || token[0] == '#') {
+        return 0;
+    }
+    while (token != NULL && argc < IMPORT_MAX_TOKENS) {
+        if (strlen(token) >= sizeof(task->exec_file_name)) {
+            return -1;
+        }
+        argv[argc++] = token;
+        token = strtok_r(NULL, " \t\r", &save_ptr);
+    }
+
+    // Import przyjmuje wyłącznie komendy planujące zadania
+    if (strcmp(argv[1], "RELATIVE") != 0 && strcmp(argv[1], "ABSOLUTE") != 0 && strcmp(argv[1], "PERIODIC") != 0) {
+        return -1;
+    }
+    struct query_t query;
+    memset(&query, 0, sizeof(struct query_t));
+    if (handle_program_arguments(argc, argv, &query) != 0) {
+        return -1;
+    }
+    memset(task, 0, sizeof(struct task_t));
+    scheduler_fill_task(task, &query, cur_time);
+    return 1;
+}
+
+// Wątek parsujący zakres linii; wynik trafia do komórki o numerze linii
+static void *import_parse_range(void *arg) {
+    struct import_range_t *range = (struct import_range_t *)arg;
+    for (int i = range->first_line; i < range->last_line; i++) {
+        size_t start = range->line_starts[i];
+        const char *end = memchr(range->data + start, '\n', range->data_size - start);
+        size_t length = end ? (size_t)(end - (range->data + start)) : range->data_size - start;
+        int result = import_parse_line(range->data + start, length, range->cur_time, &range->tasks[i]);
+        if (result <= 0) {
+            range->tasks[i].is_active = 0;
+        }
+        if (result < 0) {
+            range->rejected++;
+        }
+    }
+    return NULL;
+}
+
+// Czy linia może zawierać zadanie (nie jest pusta ani nie jest komentarzem)
+static int import_candidate_line(const char *line, const char *end) {
+    while (line < end && (*line == ' ' || *line == '\t' || *line == '\r')) {
+        line++;
+    }
+    return line < end && *line != '\n' && *line != '#';
+}
+
+// Wczytanie pliku z zadaniami; linie dzielone są między wątki według zakresów.
+// Limit (ujemny - bez limitu) ogranicza liczbę parsowanych linii z zadaniami,
+// pozostałe nie są parsowane i trafiają do skipped
+int import_parse_file(const char *path, time_t cur_time, int limit, struct task_t **tasks, int *count, int *rejected,
+                      int *skipped) {
+    *tasks = NULL;
+    *count = 0;
+    *rejected = 0;
+    *skipped = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return -1;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return -1;
+    }
+    if (file_stat.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    size_t data_size = file_stat.st_size;
+    const char *data = mmap(NULL, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+
+    // Początki linii - jedno przejście po pliku; linie po osiągnięciu limitu tylko liczone
+    int lines = 0;
+    int candidates = 0;
+    for (const char *p = data; p != NULL && p < data + data_size;) {
+        int candidate = import_candidate_line(p, data + data_size);
+        if (limit >= 0 && candidates >= limit) {
+            *skipped += candidate;
+        } else {
+            candidates += candidate;
+            lines++;
+        }
+        p = memchr(p, '\n', data + data_size - p);
+        if (p != NULL) {
+            p++;
+        }
+    }
+    if (lines == 0) {
+        munmap((void *)data, data_size);
+        return 0;
+    }
+    size_t *line_starts = malloc(lines * sizeof(size_t));
+    struct task_t *parsed = malloc(lines * sizeof(struct task_t));
+    if (line_starts == NULL || parsed == NULL) {
+        free(line_starts);
+        free(parsed);
+        munmap((void *)data, data_size);
+        return -2;
+    }
+    const char *p = data;
+    for (int i = 0; i < lines; i++) {
+        line_starts[i] = p - data;
+        p = memchr(p, '\n', data + data_size - p);
+        p = p ? p + 1 : data + data_size;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = lines / IMPORT_LINES_PER_THREAD + 1;
+    if (threads > cpus) {
+        threads = cpus > 0 ? cpus : 1;
+    }
+    if (threads > IMPORT_MAX_THREADS) {
+        threads = IMPORT_MAX_THREADS;
+    }
+
+    struct import_range_t ranges[IMPORT_MAX_THREADS];
+    pthread_t thread_ids[IMPORT_MAX_THREADS];
+    int chunk = (lines + threads - 1) / threads;
+    for (int i = 0; i < threads; i++) {
+        ranges[i].data = data;
+        ranges[i].data_size = data_size;
+        ranges[i].line_starts = line_starts;
+        ranges[i].first_line = i * chunk < lines ? i * chunk : lines;
+        ranges[i].last_line = (i + 1) * chunk < lines ? (i + 1) * chunk : lines;
+        ranges[i].cur_time = cur_time;
+        ranges[i].tasks = parsed;
+        ranges[i].rejected = 0;
+    }
+    // Wątek główny parsuje pierwszy zakres; nieudane tworzenie wątku przechodzi na parsowanie w miejscu
+    int started[IMPORT_MAX_THREADS] = { 0 };
+    for (int i = 1; i < threads; i++) {
+        started[i] = pthread_create(&thread_ids[i], NULL, import_parse_range, &ranges[i]) == 0;
+    }
+    import_parse_range(&ranges[0]);
+    for (int i = 1; i < threads; i++) {
+        if (started[i]) {
+            pthread_join(thread_ids[i], NULL);
+        } else {
+            import_parse_range(&ranges[i]);
+        }
+    }
+    munmap((void *)data, data_size);
+    free(line_starts);
+
+    // Zachowanie kolejności z pliku - usunięcie pustych i błędnych linii
+    int valid = 0;
+    for (int i = 0; i < lines; i++) {
+        if (parsed[i].is_active) {
+            parsed[valid++] = parsed[i];
+        }
+    }
+    for (int i = 0; i < threads; i++) {
+        *rejected += ranges[i].rejected;
+    }
+    *tasks = parsed;
+    *count = valid;
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef PROJECT2_IMPORT_H
+#define PROJECT2_IMPORT_H
+
+#include "scheduler.h"
+
+#define IMPORT_MAX_THREADS 16
+#define IMPORT_LINES_PER_THREAD 4096
+#define IMPORT_LINE_LENGTH 1024
+#define IMPORT_MAX_TOKENS 16
+
+// Zakres linii parsowany przez jeden wątek
+struct import_range_t{
+    const char *data;
+    size_t data_size;
+    const size_t *line_starts;
+    int first_line;
+    int last_line;
+    time_t cur_time;
+    struct task_t *tasks;
+    int rejected;
+};
+
+int import_parse_file(const char *path, time_t cur_time, int limit, struct task_t **tasks, int *count, int *rejected,
+                      int *skipped);
+
+#endif
@@ -1,4 +1,5 @@
 #include "logger.h"
+#include "civil_time.h"
 #include <stdio.h>
 #include <stdarg.h>
 #include <signal.h>
@@ -68,7 +69,8 @@ void *handle_dump(void *arg) {
 
         pthread_mutex_lock(&dump_mutex);
         time_t now = time(NULL);
-        struct tm *tm_info = localtime(&now);
+        struct tm tm_buffer;
+        struct tm *tm_info = civil_localtime(&now, &tm_buffer);
         char filename[64];
         strftime(filename, sizeof(filename), "dump_%Y-%m-%d_%H:%M:%S.dump", tm_info);
         FILE *dump_file = fopen(filename, "w");
@@ -171,7 +173,8 @@ int write_log(int level, const char *fmt, ...) {
     va_list args;
     va_start(args, fmt);
     time_t now = time(NULL);
-    struct tm *tm_info = localtime(&now);
+    struct tm tm_buffer;
+    struct tm *tm_info = civil_localtime(&now, &tm_buffer);
     if (level == MIN) {
         fprintf(log_file, "[%02d:%02d:%02d] [MIN]: ", tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
     }
@@ -1,20 +1,45 @@
 #include "scheduler.h"
 #include <stdio.h>
 #include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
 
 // Względnie: RELATIVE yyyy dd hh mm ss plik
 // Bezwzględnie: ABSOLUTE yyyy dd hh mm ss plik
 // Cyklicznie: PERIODIC yyyy dd hh mm ss plik
 // Lista zadań: DISPLAY
-// Anulowanie zadania: CANDEL task_id
+// Zadanie zależne: DEPENDENT SUCCESS|FAILURE|COMPLETION plik task_id [task_id...]
+// Anulowanie zadania: CANDEL task_id | CANCEL TAG tag | CANCEL NAME wzorzec
+// Wstrzymanie i wznowienie zadań: PAUSE/RESUME task_id | TAG tag | NAME wzorzec
 // Wyłączenie serwera: SHUTDOWN
+// Limity zadania (opcjonalnie): --timeout s --cpu s --memory MB --files n --nice n
+// Tagi zadania (opcjonalnie): --tag nazwa (do 4 razy)
+// Przekazanie pracy nowemu plikowi wykonywalnemu: HANDOVER [plik]
+// Import zadań z pliku: IMPORT plik (przy pierwszym uruchomieniu - import podczas startu serwera)
+// Tryb wsadowy: BATCH (komendy z wejścia standardowego, jedna na linię, w jednej sesji)
 
 int main(int argc, char **argv) {
+    // serwer wznowiony po HANDOVER
+    if (argc >= 4 && strcmp(argv[1], "--resume") == 0) {
+        int result = scheduler_server_resume(atoi(argv[2]), atoi(argv[3]), argc >= 5 ? argv[4] : NULL);
+        if (result == -3) {
+            printf("Nieprawidłowe wznowienie serwera - brak stanu przekazanego przez HANDOVER!\n");
+        }
+        return result;
+    }
+    // sprawdzenie zgodności przed HANDOVER
+    if (argc >= 3 && strcmp(argv[1], "--handover-check") == 0) {
+        return scheduler_handover_check(argv[2]) == 0 ? 0 : 1;
+    }
     // serwer
     if (is_server_working() == 0) {
+        const char *import_path = NULL;
+        if (argc >= 3 && strcmp(argv[1], "IMPORT") == 0) {
+            import_path = argv[2];
+        }
         printf("Trwa uruchamianie serwera...\n");
         if (fork() == 0) {
-            int server = scheduler_server();
+            int server = scheduler_server(import_path);
             if (server != 0) {
                 printf("Nie udało się utworzyć serwera!\n");
                 return -1;
@@ -36,6 +61,18 @@ int main(int argc, char **argv) {
         printf("Błędna komenda!\n");
         return -4;
     }
+    else if (client == -7) {
+        printf("Brak odpowiedzi serwera w wyznaczonym czasie!\n");
+        return -6;
+    }
+    else if (client == -9) {
+        printf("Nie wszystkie komendy zostały wykonane!\n");
+        return -7;
+    }
+    else if (client == -8) {
+        printf("Serwer przeciążony - spróbuj ponownie później!\n");
+        return -5;
+    }
     else if (client !=0) {
         printf("Nie udało się utworzyć klienta!\n");
         return -1;
@@ -1,5 +1,8 @@
 #include "scheduler.h"
 #include "logger.h"
+#include "shm_ring.h"
+#include "import.h"
+#include "civil_time.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,10 +10,36 @@
 #include <pthread.h>
 #include <unistd.h>
 #include <signal.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
 
 pthread_mutex_t task_mutex = PTHREAD_MUTEX_INITIALIZER;
 struct task_list_t *scheduler_list = NULL;
 int ID = 0;
+struct shm_ring_t *scheduler_ring = NULL;
+pthread_t ring_thread;
+struct deadline_heap_t scheduler_heap;
+timer_t dispatch_timer;
+struct instance_list_t scheduler_instances;
+pthread_cond_t child_cond = PTHREAD_COND_INITIALIZER;
+pthread_t reaper_thread;
+struct scheduler_stats_t scheduler_stats;
+struct tag_index_t scheduler_tags;
+mqd_t scheduler_queue = -1;
+struct client_rate_t scheduler_rates[RATE_LIMIT_CLIENTS];
+int scheduler_overloaded = 0;
+int scheduler_rate_limit = RATE_LIMIT_REQUESTS;
+int scheduler_max_tasks = MAX_LIVE_TASKS;
+int scheduler_stale_entries = 0;
+unsigned long scheduler_instance_sequence = 0;
 
 // Sprawdzenie czy serwer działa
 int is_server_working() {
@@ -22,10 +51,18 @@ int is_server_working() {
     return 1;
 }
 
-// Serwer
-int scheduler_server() {
+// Inicjalizacja struktur serwera, zegara dyspozytora i wątku zbierającego procesy
+int scheduler_server_init() {
     init_logger();
-    write_log(MAX, "Uruchomienie harmonogramu.");
+    set_dump_callback(scheduler_dump);
+    const char *rate_env = getenv(RATE_LIMIT_ENV);
+    if (rate_env != NULL && atoi(rate_env) >= 0) {
+        scheduler_rate_limit = atoi(rate_env);
+    }
+    const char *max_tasks_env = getenv(MAX_TASKS_ENV);
+    if (max_tasks_env != NULL && atoi(max_tasks_env) >= 0) {
+        scheduler_max_tasks = atoi(max_tasks_env);
+    }
 
     scheduler_list = calloc(1, sizeof(struct task_list_t));
     if (scheduler_list == NULL) {
@@ -40,6 +77,47 @@ int scheduler_server() {
         close_logger();
         return -1;
     }
+    if (init_deadline_heap(&scheduler_heap, INITIAL_CAPACITY) != 0 || init_tag_index(&scheduler_tags) != 0) {
+        write_log(MIN, "Błąd alokacji pamięci dla kopca terminów!");
+        free_deadline_heap(&scheduler_heap);
+        free_task_list(scheduler_list);
+        free(scheduler_list);
+        scheduler_list = NULL;
+        close_logger();
+        return -1;
+    }
+
+    // Jeden zegar interwałowy dla wszystkich zadań, ustawiany na najbliższy termin
+    struct sigevent sev;
+    memset(&sev, 0, sizeof(struct sigevent));
+    sev.sigev_notify = SIGEV_THREAD;
+    sev.sigev_notify_function = scheduler_dispatch;
+    sev.sigev_notify_attributes = NULL;
+    if (timer_create(CLOCK_REALTIME, &sev, &dispatch_timer) != 0) {
+        write_log(MIN, "Błąd timera!");
+        free_tag_index(&scheduler_tags);
+        free_deadline_heap(&scheduler_heap);
+        free_task_list(scheduler_list);
+        free(scheduler_list);
+        scheduler_list = NULL;
+        close_logger();
+        return -1;
+    }
+
+    if (pthread_create(&reaper_thread, NULL, scheduler_reaper, NULL) != 0) {
+        write_log(MIN, "Błąd uruchamiania wątku zbierającego procesy!");
+    } else {
+        pthread_detach(reaper_thread);
+    }
+    return 0;
+}
+
+// Serwer
+int scheduler_server(const char *import_path) {
+    if (scheduler_server_init() != 0) {
+        return -1;
+    }
+    write_log(MAX, "Uruchomienie harmonogramu.");
 
     struct mq_attr queue_attr;
     queue_attr.mq_flags = 0;
@@ -50,13 +128,138 @@ int scheduler_server() {
     mqd_t queue_id = mq_open(QUEUE_NAME, O_RDONLY | O_CREAT | O_EXCL, 0666, &queue_attr);
     if (queue_id == -1) {
         write_log(MIN, "Błąd otwierania kolejki!");
+        pthread_mutex_lock(&task_mutex);
+        timer_delete(dispatch_timer);
+        free_tag_index(&scheduler_tags);
+        free_deadline_heap(&scheduler_heap);
         free_task_list(scheduler_list);
         free(scheduler_list);
         scheduler_list = NULL;
+        pthread_cond_signal(&child_cond);
+        pthread_mutex_unlock(&task_mutex);
         close_logger();
         return -2;
     }
 
+    if (import_path != NULL) {
+        scheduler_import_tasks(import_path, 0);
+    }
+
+    scheduler_ring = shm_ring_create();
+    if (scheduler_ring == NULL) {
+        write_log(MIN, "Błąd tworzenia pierścienia zapytań - dostępna tylko kolejka komunikatów.");
+    }
+    return scheduler_server_run(queue_id);
+}
+
+// Sprawdzenie deskryptorów przekazanych przez --resume przed jakąkolwiek zmianą stanu:
+// stan w memfd zapisanym przez HANDOVER, kolejka serwera i pierścień bez innego właściciela
+int scheduler_validate_resume(int state_fd, int queue_fd) {
+    struct stat state_stat;
+    char fd_path[64];
+    char target[64];
+    sprintf(fd_path, "/proc/self/fd/%d", state_fd);
+    ssize_t length = readlink(fd_path, target, sizeof(target) - 1);
+    if (state_fd < 0 || fstat(state_fd, &state_stat) != 0 || !S_ISREG(state_stat.st_mode) ||
+        state_stat.st_size < (off_t)sizeof(struct handover_header_t) || length <= 0) {
+        return -1;
+    }
+    target[length] = '\0';
+    if (strncmp(target, "/memfd:scheduler_state", strlen("/memfd:scheduler_state")) != 0) {
+        return -1;
+    }
+
+    // Deskryptor musi wskazywać tę samą kolejkę co QUEUE_NAME
+    struct mq_attr queue_attr;
+    struct stat queue_stat;
+    struct stat named_stat;
+    if (queue_fd < 0 || mq_getattr((mqd_t)queue_fd, &queue_attr) != 0 ||
+        queue_attr.mq_msgsize != sizeof(struct query_t) || fstat(queue_fd, &queue_stat) != 0) {
+        return -2;
+    }
+    mqd_t named = mq_open(QUEUE_NAME, O_RDONLY | O_NONBLOCK);
+    if (named == -1) {
+        return -2;
+    }
+    int same = fstat((int)named, &named_stat) == 0 && named_stat.st_ino == queue_stat.st_ino &&
+               named_stat.st_dev == queue_stat.st_dev;
+    mq_close(named);
+    if (!same) {
+        return -2;
+    }
+
+    // Po exec PID się nie zmienia - inny żywy właściciel oznacza działający serwer
+    struct shm_ring_t *ring = shm_ring_attach();
+    if (ring != NULL) {
+        pid_t owner = ring->server_pid;
+        shm_ring_detach(ring);
+        if (owner != getpid() && owner > 0 && (kill(owner, 0) == 0 || errno == EPERM)) {
+            return -3;
+        }
+    }
+    return 0;
+}
+
+// Wznowienie serwera w nowym pliku wykonywalnym ze stanu przekazanego przez HANDOVER;
+// fallback - poprzedni plik wykonywalny, uruchamiany ponownie, gdy stanu nie da się odczytać
+int scheduler_server_resume(int state_fd, int queue_fd, const char *fallback) {
+    if (scheduler_validate_resume(state_fd, queue_fd) != 0) {
+        return -3;
+    }
+    if (scheduler_server_init() != 0) {
+        close(state_fd);
+        return -1;
+    }
+    mqd_t queue_id = (mqd_t)queue_fd;
+
+    int result = scheduler_restore_state(state_fd);
+    if (result < 0) {
+        // Nigdy nie pracujemy dalej z pustym harmonogramem - powrót do poprzedniego pliku
+        if (fallback != NULL) {
+            write_log(MIN, "Błąd odtwarzania stanu harmonogramu (kod %d) - powrót do %s.", result, fallback);
+            char state_arg[16];
+            char queue_arg[16];
+            sprintf(state_arg, "%d", state_fd);
+            sprintf(queue_arg, "%d", queue_fd);
+            execl(fallback, fallback, "--resume", state_arg, queue_arg, (char *)NULL);
+        }
+        write_log(MIN, "Błąd odtwarzania stanu harmonogramu (kod %d) - harmonogram zatrzymany.", result);
+        close(state_fd);
+        scheduler_ring = shm_ring_attach();
+        if (scheduler_ring != NULL) {
+            shm_ring_close(scheduler_ring);
+            shm_ring_destroy(scheduler_ring);
+            scheduler_ring = NULL;
+        }
+        mq_close(queue_id);
+        mq_unlink(QUEUE_NAME);
+        close_logger();
+        return -4;
+    }
+    close(state_fd);
+    write_log(MAX, "Wznowienie harmonogramu po przekazaniu (zadania: %d).", result);
+    // Kolejka pozostaje otwarta - nie może być dziedziczona przez uruchamiane zadania
+    fcntl(queue_fd, F_SETFD, FD_CLOEXEC);
+
+    scheduler_ring = shm_ring_resume();
+    if (scheduler_ring == NULL) {
+        scheduler_ring = shm_ring_create();
+    }
+    if (scheduler_ring == NULL) {
+        write_log(MIN, "Błąd tworzenia pierścienia zapytań - dostępna tylko kolejka komunikatów.");
+    }
+    return scheduler_server_run(queue_id);
+}
+
+// Główna pętla serwera
+int scheduler_server_run(mqd_t queue_id) {
+    scheduler_queue = queue_id;
+    if (scheduler_ring != NULL && pthread_create(&ring_thread, NULL, scheduler_ring_worker, NULL) != 0) {
+        write_log(MIN, "Błąd uruchamiania wątku pierścienia zapytań!");
+        shm_ring_destroy(scheduler_ring);
+        scheduler_ring = NULL;
+    }
+
     struct query_t scheduler_query;
     while(1) {
         ssize_t bytes = mq_receive(queue_id, (char *)&scheduler_query, sizeof(struct query_t), NULL);
@@ -64,283 +267,1916 @@ int scheduler_server() {
             write_log(MIN, "Błąd odbioru wiadomosci!");
             continue;
         }
+        // Sloty pierścienia należą tylko do zapytań z pierścienia
+        scheduler_query.reply_slot = -1;
+        scheduler_query.posted = 0;
 
-        if (scheduler_query.command == RELATIVE) {
-            int result = scheduler_add_task(&scheduler_query);
-            if (result >= 0) {
-                write_log(STANDARD, "Zadanie %d dodane pomyslnie.", result);
-            }
-            else {
-                write_log(STANDARD, "Nie udało się dodać nowego zadania.");
+        if (scheduler_query.command == SHUTDOWN) {
+            write_log(MAX, "Zamknięcie harmonogramu.");
+            scheduler_shutdown(queue_id);
+            break;
+        }
+        if (scheduler_query.command == HANDOVER) {
+            // Powrót oznacza nieudane przekazanie - serwer pracuje dalej
+            if (scheduler_validate_query(&scheduler_query) != 0) {
+                write_log(MIN, "Odrzucono nieprawidłowe zapytanie (PID %d).", scheduler_query.client_pid);
+            } else {
+                scheduler_handover(queue_id, &scheduler_query);
             }
+            continue;
+        }
+        scheduler_process_query(&scheduler_query);
+    }
+    return 0;
+}
+
+// Sprawdzenie pól zapytania pochodzących od klienta przed ich użyciem: napisy zakończone
+// znakiem '\0', liczba tagów w zakresie; -1 - zapytanie odrzucone
+int scheduler_validate_query(struct query_t *query) {
+    if (memchr(query->reply_name, '\0', sizeof(query->reply_name)) == NULL) {
+        // Bez poprawnej nazwy kolejki odpowiedź nie jest wysyłana
+        query->reply_name[0] = '\0';
+        return -1;
+    }
+    if (memchr(query->exec_file_name, '\0', sizeof(query->exec_file_name)) == NULL ||
+        query->tag_count < 0 || query->tag_count > MAX_TAGS) {
+        return -1;
+    }
+    for (int i = 0; i < query->tag_count; i++) {
+        if (memchr(query->tags[i], '\0', TAG_LENGTH) == NULL) {
+            return -1;
+        }
+    }
+    if (query->selector == BY_TAG && memchr(query->tags[0], '\0', TAG_LENGTH) == NULL) {
+        return -1;
+    }
+    return 0;
+}
+
+// Obsługa pojedynczego zapytania (kolejka komunikatów lub pierścień)
+void scheduler_process_query(struct query_t *query) {
+    int result = 0;
+    if (scheduler_validate_query(query) != 0) {
+        write_log(MIN, "Odrzucono nieprawidłowe zapytanie (PID %d).", query->client_pid);
+        scheduler_reply_status(query, -1);
+        return;
+    }
+    if (scheduler_admit(query) != 0) {
+        scheduler_reply_status(query, STATUS_BUSY);
+        return;
+    }
+    if (query->command == RELATIVE || query->command == ABSOLUTE || query->command == PERIODIC ||
+        query->command == DEPENDENT) {
+        result = query->command == DEPENDENT ? scheduler_add_dependent(query) : scheduler_add_task(query);
+        if (result >= 0) {
+            write_log(STANDARD, "Zadanie %d dodane pomyslnie.", result);
+        }
+        else {
+            write_log(STANDARD, "Nie udało się dodać nowego zadania.");
+        }
+    }
+    else if (query->command == DISPLAY) {
+        scheduler_display_tasks(query);
+        return;
+    }
+    else if (query->command == CANCEL && query->selector == BY_ID) {
+        result = scheduler_bulk_update(query);
+        if (result <= 0) {
+            write_log(STANDARD, "Nie udało się usunąć zadania o numerze %d", query->task_id);
+        }
+        else {
+            write_log(STANDARD, "Usunięto zadania o numerze %d.", query->task_id);
+        }
+    }
+    else if (query->command == CANCEL || query->command == PAUSE || query->command == RESUME) {
+        static const char *actions[] = { "Usunięto", "Wstrzymano", "Wznowiono" };
+        int action = query->command == CANCEL ? 0 : (query->command == PAUSE ? 1 : 2);
+        result = scheduler_bulk_update(query);
+        if (query->selector == BY_ID) {
+            write_log(STANDARD, "%s zadań: %d (ID %d).", actions[action], result, query->task_id);
+        } else if (query->selector == BY_TAG) {
+            write_log(STANDARD, "%s zadań: %d (tag %s).", actions[action], result, query->tags[0]);
+        } else {
+            write_log(STANDARD, "%s zadań: %d (wzorzec %s).", actions[action], result, query->exec_file_name);
+        }
+    }
+    else if (query->command == IMPORT) {
+        result = scheduler_import_tasks(query->exec_file_name, 1);
+    }
+    else if (query->command == NEGOTIATE) {
+        scheduler_negotiate(query);
+        return;
+    }
+    else {
+        write_log(MIN, "Błędna komenda!");
+        result = -1;
+    }
+
+    scheduler_reply_status(query, result);
+}
+
+// Odpowiedź z wynikiem zapytania - klienci pierścienia zawsze otrzymują potwierdzenie,
+// klienci kolejki - gdy podali kolejkę odpowiedzi; odrzucenie zapytania wysłanego
+// bez odpowiedzi jest zliczane w slocie klienta
+void scheduler_reply_status(struct query_t *query, int status) {
+    struct reply_t reply;
+    memset(&reply, 0, sizeof(struct reply_t));
+    reply.status = status;
+    if (query->posted) {
+        if (status == STATUS_BUSY && scheduler_ring != NULL) {
+            shm_ring_count_rejected(scheduler_ring, query->reply_slot);
+        }
+    }
+    else if (query->reply_slot >= 0) {
+        if (scheduler_send_reply(query, -1, &reply) != 0) {
+            write_log(MIN, "Błąd wysyłania odpowiedzi do klienta!");
+        }
+    }
+    else if (query->reply_slot < 0 && query->reply_name[0] != '\0') {
+        mqd_t reply_queue = mq_open(query->reply_name, O_WRONLY);
+        if (reply_queue == -1 || scheduler_send_reply(query, reply_queue, &reply) != 0) {
+            write_log(MIN, "Błąd wysyłania odpowiedzi do klienta!");
+        }
+        if (reply_queue != -1) {
+            mq_close(reply_queue);
+        }
+    }
+}
+
+// Kontrola przyjęcia zapytania: limit zadań, limit zapytań klienta kolejki i odrzucanie
+// kosztownych zapytań przy zapełnionej kolejce; 0 - przyjęte, STATUS_BUSY - odrzucone
+int scheduler_admit(struct query_t *query) {
+    // Zapytania sterujące i zmniejszające obciążenie są zawsze przyjmowane
+    if (query->command == NEGOTIATE || query->command == CANCEL || query->command == PAUSE ||
+        query->command == SHUTDOWN || query->command == HANDOVER) {
+        return 0;
+    }
+
+    long depth = 0;
+    struct mq_attr queue_attr;
+    if (scheduler_queue != -1 && mq_getattr(scheduler_queue, &queue_attr) == 0) {
+        depth = queue_attr.mq_curmsgs;
+    }
+    int overloaded = depth >= QUEUE_HIGH_WATERMARK ||
+                     (scheduler_ring != NULL && shm_ring_depth(scheduler_ring) >= RING_HIGH_WATERMARK);
+
+    pthread_mutex_lock(&task_mutex);
+    if (overloaded != scheduler_overloaded) {
+        scheduler_overloaded = overloaded;
+        if (overloaded) {
+            write_log(MIN, "Przeciążenie - kolejka: %ld, pierścień: %lu.", depth,
+                      scheduler_ring != NULL ? shm_ring_depth(scheduler_ring) : 0);
+        } else {
+            write_log(STANDARD, "Koniec przeciążenia.");
         }
-        else if (scheduler_query.command == ABSOLUTE) {
-            int result = scheduler_add_task(&scheduler_query);
-            if (result >= 0) {
-                write_log(STANDARD, "Zadanie %d dodane pomyslnie.", result);
+    }
+
+    int busy = 0;
+    if (overloaded && (query->command == DISPLAY || query->command == IMPORT)) {
+        busy = 1;
+    }
+    else if ((query->command == RELATIVE || query->command == ABSOLUTE || query->command == PERIODIC ||
+              query->command == DEPENDENT) && scheduler_max_tasks > 0 && scheduler_list->size >= scheduler_max_tasks) {
+        busy = 1;
+    }
+    else if (query->reply_slot < 0 && scheduler_rate_limit > 0) {
+        // Każde wywołanie klienta to nowy proces, więc limit liczony jest dla UID;
+        // wybierany jest slot tego UID albo slot z najstarszym oknem
+        time_t now = time(NULL);
+        struct client_rate_t *rate = &scheduler_rates[0];
+        for (int i = 0; i < RATE_LIMIT_CLIENTS; i++) {
+            if (scheduler_rates[i].window != 0 && scheduler_rates[i].uid == query->client_uid) {
+                rate = &scheduler_rates[i];
+                break;
             }
-            else {
-                write_log(STANDARD, "Nie udało się dodać nowego zadania.");
+            if (scheduler_rates[i].window < rate->window) {
+                rate = &scheduler_rates[i];
             }
         }
-        else if (scheduler_query.command == PERIODIC) {
-            int result = scheduler_add_task(&scheduler_query);
-            if (result >= 0) {
-                write_log(STANDARD, "Zadanie %d dodane pomyslnie.", result);
+        if (rate->window == 0 || rate->uid != query->client_uid || now - rate->window >= RATE_LIMIT_WINDOW) {
+            rate->uid = query->client_uid;
+            rate->window = now;
+            rate->count = 0;
+        }
+        rate->last_pid = query->client_pid;
+        if (++rate->count > scheduler_rate_limit) {
+            busy = 1;
+            if (rate->count == scheduler_rate_limit + 1) {
+                write_log(STANDARD, "Limit zapytań klienta UID %d (PID %d) przekroczony.", (int)rate->uid,
+                          (int)rate->last_pid);
+            }
+        }
+    }
+    if (busy) {
+        scheduler_stats.rejected++;
+    }
+    pthread_mutex_unlock(&task_mutex);
+    return busy ? STATUS_BUSY : 0;
+}
+
+// Przydzielenie klientowi slotu odpowiedzi w pierścieniu
+void scheduler_negotiate(struct query_t *query) {
+    mqd_t reply_queue = mq_open(query->reply_name, O_WRONLY);
+    if (reply_queue == -1) {
+        write_log(MIN, "Błąd otwierania kolejki odpowiedzi!");
+        return;
+    }
+    struct reply_t reply;
+    memset(&reply, 0, sizeof(struct reply_t));
+    reply.status = -1;
+    if (scheduler_ring != NULL) {
+        reply.status = shm_ring_acquire_slot(scheduler_ring, query->client_pid);
+        strcpy(reply.data, RING_NAME);
+    }
+    if (mq_send(reply_queue, (const char *)&reply, sizeof(struct reply_t), 0) == -1) {
+        write_log(MIN, "Błąd wysyłania odpowiedzi do klienta!");
+    }
+    mq_close(reply_queue);
+}
+
+// Wątek obsługujący zapytania z pierścienia w pamięci współdzielonej
+void *scheduler_ring_worker(void *arg) {
+    struct query_t query;
+    while (shm_ring_pop(scheduler_ring, &query) == 0) {
+        if (query.command != SHUTDOWN && query.command != HANDOVER) {
+            scheduler_process_query(&query);
+            continue;
+        }
+        // Zamknięcie i przekazanie pracy wykonuje główna pętla - przekazanie przez kolejkę.
+        // Pełna kolejka nie może blokować wątku: główna pętla mogła już zacząć zamykanie
+        // i czekać na jego zakończenie - wysyłanie z terminem do zamknięcia lub przerwania pierścienia
+        struct query_t forwarded = query;
+        forwarded.reply_slot = -1;
+        forwarded.posted = 0;
+        int sent = -1;
+        mqd_t queue_id = mq_open(QUEUE_NAME, O_WRONLY);
+        while (queue_id != -1 && sent != 0 && !atomic_load(&scheduler_ring->closed) &&
+               !atomic_load(&scheduler_ring->interrupted)) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += REPLY_TIMEOUT;
+            sent = mq_timedsend(queue_id, (const char *)&forwarded, sizeof(struct query_t), 0, &deadline);
+        }
+        if (queue_id != -1) {
+            mq_close(queue_id);
+        }
+        if (sent != 0) {
+            write_log(MIN, "Nie przekazano zapytania z pierścienia do kolejki!");
+        }
+        scheduler_reply_status(&query, sent == 0 ? 0 : -1);
+    }
+    return NULL;
+}
+
+// Klient
+int scheduler_client(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "BATCH") == 0) {
+        return scheduler_batch(stdin);
+    }
+    struct query_t scheduler_query;
+    memset(&scheduler_query, 0, sizeof(struct query_t));
+    int arguments = handle_program_arguments(argc, argv, &scheduler_query);
+    if (arguments != 0) {
+        return arguments;
+    }
+
+    // Pojedyncze wywołanie nie opłaca negocjacji pierścienia - zapytanie idzie kolejką,
+    // pierścień służy długotrwałym sesjom (BATCH, scheduler_session_open)
+    struct client_session_t session;
+    session.ring = NULL;
+    session.reply_slot = -1;
+    scheduler_session_deadline(&session);
+    int result = scheduler_session_retry(&session, &scheduler_query);
+    scheduler_session_close(&session);
+    if (result == STATUS_BUSY) {
+        return -8;
+    }
+    if (result >= 0 && (scheduler_query.command == CANCEL || scheduler_query.command == PAUSE ||
+                        scheduler_query.command == RESUME)) {
+        printf("Liczba zadań: %d\n", result);
+    }
+    return result < 0 ? result : 0;
+}
+
+// Tryb wsadowy: komendy z wejścia w składni wiersza poleceń (jedna na linię) wysyłane w jednej
+// sesji - pierścień negocjowany raz, w razie braku zostaje kolejka komunikatów
+int scheduler_batch(FILE *input) {
+    struct client_session_t session;
+    scheduler_session_open(&session);
+
+    char line[IMPORT_LINE_LENGTH];
+    int line_number = 0;
+    int failed = 0;
+    while (fgets(line, sizeof(line), input) != NULL) {
+        line_number++;
+        if (strchr(line, '\n') == NULL && !feof(input)) {
+            // Zbyt długa linia - pominięcie reszty
+            int c;
+            while ((c = fgetc(input)) != EOF && c != '\n') {
             }
-            else {
-                write_log(STANDARD, "Nie udało się dodać nowego zadania.");
+            printf("Linia %d: zbyt długa!\n", line_number);
+            failed++;
+            continue;
+        }
+        char *argv[IMPORT_MAX_TOKENS];
+        int argc = 0;
+        argv[argc++] = "scheduler";
+        char *save_ptr = NULL;
+        char *token = strtok_r(line, " \t\r\n", &save_ptr);
+        if (token == NULL || token[0] == '#') {
+            continue;
+        }
+        while (token != NULL && argc < IMPORT_MAX_TOKENS) {
+            argv[argc++] = token;
+            token = strtok_r(NULL, " \t\r\n", &save_ptr);
+        }
+
+        struct query_t query;
+        memset(&query, 0, sizeof(struct query_t));
+        int result = handle_program_arguments(argc, argv, &query);
+        if (result == 0) {
+            // Termin liczony dla każdej komendy osobno
+            scheduler_session_deadline(&session);
+            result = scheduler_session_retry(&session, &query);
+        }
+        if (result < 0) {
+            printf("Linia %d: %s (kod %d)\n", line_number,
+                   result == STATUS_BUSY ? "serwer przeciążony" : "komenda nie została wykonana", result);
+            failed++;
+        }
+        else if (query.command == CANCEL || query.command == PAUSE || query.command == RESUME) {
+            printf("Linia %d: liczba zadań: %d\n", line_number, result);
+        }
+    }
+    scheduler_session_close(&session);
+    return failed > 0 ? -9 : 0;
+}
+
+// Wysłanie zapytania sesji z ponowieniami do jej terminu; odpowiedź "zajęty" oznacza,
+// że zapytanie nie zostało wykonane - można je powtórzyć
+int scheduler_session_retry(struct client_session_t *session, struct query_t *query) {
+    int backoff_ms = SEND_BACKOFF_MS;
+    int result = scheduler_session_request(session, query);
+    while (result == STATUS_BUSY && scheduler_backoff(&session->deadline, &backoff_ms) == 0) {
+        result = scheduler_session_request(session, query);
+    }
+    return result;
+}
+
+// Odczekanie przed ponowieniem zapytania (wykładniczo, z rozrzutem zależnym od PID);
+// -1 gdy termin klienta minął
+int scheduler_backoff(const struct timespec *deadline, int *backoff_ms) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    long remaining_ms = (deadline->tv_sec - now.tv_sec) * 1000 + (deadline->tv_nsec - now.tv_nsec) / 1000000;
+    if (remaining_ms <= 0) {
+        return -1;
+    }
+    long delay_ms = *backoff_ms + getpid() % (*backoff_ms + 1);
+    if (delay_ms > remaining_ms) {
+        delay_ms = remaining_ms;
+    }
+    struct timespec delay = { delay_ms / 1000, (delay_ms % 1000) * 1000000 };
+    nanosleep(&delay, NULL);
+    *backoff_ms = *backoff_ms * 2 > SEND_BACKOFF_MAX_MS ? SEND_BACKOFF_MAX_MS : *backoff_ms * 2;
+    return 0;
+}
+
+// Termin wysyłania liczony od chwili obecnej
+static void scheduler_send_deadline(struct timespec *deadline) {
+    long timeout_ms = SEND_TIMEOUT_MS;
+    const char *timeout_env = getenv(SEND_TIMEOUT_ENV);
+    if (timeout_env != NULL && atol(timeout_env) > 0) {
+        timeout_ms = atol(timeout_env);
+    }
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (timeout_ms % 1000) * 1000000;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+// Ustawienie terminu dla kolejnych zapytań sesji
+void scheduler_session_deadline(struct client_session_t *session) {
+    scheduler_send_deadline(&session->deadline);
+}
+
+// Otwarcie sesji - negocjacja pierścienia przez kolejkę, w razie braku zostaje kolejka
+int scheduler_session_open(struct client_session_t *session) {
+    session->ring = NULL;
+    session->reply_slot = -1;
+    scheduler_session_deadline(session);
+
+    mqd_t queue_id = mq_open(QUEUE_NAME, O_WRONLY);
+    if (queue_id == -1) {
+        return -4;
+    }
+
+    struct query_t query;
+    memset(&query, 0, sizeof(struct query_t));
+    query.command = NEGOTIATE;
+    query.reply_slot = -1;
+    query.client_pid = getpid();
+    query.client_uid = getuid();
+    sprintf(query.reply_name, "/reply_queue_%d", getpid());
+    struct mq_attr reply_attr;
+    reply_attr.mq_flags = 0;
+    reply_attr.mq_maxmsg = INITIAL_CAPACITY;
+    reply_attr.mq_msgsize = sizeof(struct reply_t);
+    reply_attr.mq_curmsgs = 0;
+    mqd_t reply_id = mq_open(query.reply_name, O_RDONLY | O_CREAT | O_EXCL, 0666, &reply_attr);
+    if (reply_id == -1) {
+        mq_close(queue_id);
+        return -5;
+    }
+
+    struct reply_t reply;
+    int result = -6;
+    if (mq_timedsend(queue_id, (const char *)&query, sizeof(struct query_t), 0, &session->deadline) == 0 &&
+        mq_timedreceive(reply_id, (char *)&reply, sizeof(struct reply_t), NULL, &session->deadline) != -1 &&
+        reply.status >= 0) {
+        session->ring = shm_ring_attach();
+        if (session->ring != NULL) {
+            session->reply_slot = reply.status;
+            result = 0;
+        }
+    }
+    mq_close(queue_id);
+    mq_close(reply_id);
+    mq_unlink(query.reply_name);
+    return result;
+}
+
+// Wysłanie zapytania w ramach sesji
+int scheduler_session_request(struct client_session_t *session, struct query_t *query) {
+    query->client_pid = getpid();
+    query->client_uid = getuid();
+    if (session->ring == NULL) {
+        query->reply_slot = -1;
+        return scheduler_mq_request(query, &session->deadline);
+    }
+
+    query->reply_slot = session->reply_slot;
+    query->posted = 0;
+    int pushed = shm_ring_push(session->ring, query, &session->deadline);
+    if (pushed != 0) {
+        write_log(MIN, "Błąd wysyłania zapytania!");
+        return pushed == -2 ? STATUS_BUSY : -6;
+    }
+    struct reply_t reply;
+    while (1) {
+        if (shm_ring_receive(session->ring, session->reply_slot, &reply, &session->deadline) != 0) {
+            write_log(MIN, "Błąd odbierania odpowiedzi z pierścienia!");
+            // Spóźniona odpowiedź trafiłaby do kolejnego zapytania - slot pozostaje zajęty
+            // do końca procesu, a sesja przechodzi na kolejkę komunikatów
+            shm_ring_detach(session->ring);
+            session->ring = NULL;
+            session->reply_slot = -1;
+            return -7;
+        }
+        if (query->command != DISPLAY || reply.status == STATUS_BUSY) {
+            return reply.status;
+        }
+        // Sygnał końcowy
+        if (strlen(reply.data) == 0) {
+            return 0;
+        }
+        printf("%s\n", reply.data);
+        // Termin ogranicza oczekiwanie na kolejny wiersz, nie całą listę
+        scheduler_session_deadline(session);
+    }
+}
+
+// Wysłanie zapytania bez oczekiwania na potwierdzenie (jak w kolejce komunikatów);
+// odrzucone zapytania zwraca scheduler_session_rejected
+int scheduler_session_post(struct client_session_t *session, struct query_t *query) {
+    query->client_pid = getpid();
+    query->client_uid = getuid();
+    if (session->ring == NULL || query->command == DISPLAY) {
+        return scheduler_session_request(session, query);
+    }
+    query->reply_slot = session->reply_slot;
+    query->posted = 1;
+    int pushed = shm_ring_push(session->ring, query, &session->deadline);
+    if (pushed != 0) {
+        write_log(MIN, "Błąd wysyłania zapytania!");
+        return pushed == -2 ? STATUS_BUSY : -6;
+    }
+    return 0;
+}
+
+// Liczba zapytań sesji wysłanych bez odpowiedzi i odrzuconych przez serwer od poprzedniego odczytu
+int scheduler_session_rejected(struct client_session_t *session) {
+    if (session->ring == NULL) {
+        return 0;
+    }
+    return shm_ring_take_rejected(session->ring, session->reply_slot);
+}
+
+// Zamknięcie sesji i zwolnienie slotu odpowiedzi
+void scheduler_session_close(struct client_session_t *session) {
+    if (session->ring == NULL) {
+        return;
+    }
+    int rejected = scheduler_session_rejected(session);
+    if (rejected > 0) {
+        write_log(MIN, "Serwer odrzucił zapytania wysłane bez odpowiedzi: %d.", rejected);
+    }
+    shm_ring_release_slot(session->ring, session->reply_slot);
+    shm_ring_detach(session->ring);
+    session->ring = NULL;
+    session->reply_slot = -1;
+}
+
+// Odbiór odpowiedzi z kolejki klienta do terminu sesji
+static int scheduler_mq_receive(mqd_t reply_id, struct reply_t *reply, const struct timespec *deadline) {
+    ssize_t bytes = mq_timedreceive(reply_id, (char *)reply, sizeof(struct reply_t), NULL, deadline);
+    while (bytes == -1 && errno == EINTR) {
+        bytes = mq_timedreceive(reply_id, (char *)reply, sizeof(struct reply_t), NULL, deadline);
+    }
+    return bytes == -1 ? -1 : 0;
+}
+
+// Wysłanie zapytania przez kolejkę komunikatów; pełna kolejka do terminu oznacza przeciążenie serwera
+int scheduler_mq_request(struct query_t *query, const struct timespec *deadline) {
+    mqd_t queue_id = mq_open(QUEUE_NAME, O_WRONLY);
+    if (queue_id == -1) {
+        write_log(MIN, "Błąd otwierania kolejki!");
+        return -4;
+    }
+
+    // Odpowiedź przychodzi na każde zapytanie poza zamknięciem i przekazaniem pracy,
+    // więc klient dowiaduje się o odrzuceniu
+    mqd_t reply_id = -1;
+    int expects_reply = query->command != SHUTDOWN && query->command != HANDOVER;
+    if (expects_reply) {
+        sprintf(query->reply_name, "/reply_queue_%d", getpid());
+        struct mq_attr reply_attr;
+        reply_attr.mq_flags = 0;
+        reply_attr.mq_maxmsg = INITIAL_CAPACITY;
+        reply_attr.mq_msgsize = sizeof(struct reply_t);
+        reply_attr.mq_curmsgs = 0;
+
+        reply_id = mq_open(query->reply_name, O_RDONLY | O_CREAT | O_EXCL, 0666, &reply_attr);
+        if (reply_id == -1) {
+            mq_close(queue_id);
+            write_log(MIN, "Błąd tworzenia kolejki odpowiedzi!");
+            return -5;
+        }
+    }
+
+    int result = 0;
+    int sent = mq_timedsend(queue_id, (const char*)query, sizeof(struct query_t), 0, deadline);
+    while (sent == -1 && errno == EINTR) {
+        sent = mq_timedsend(queue_id, (const char*)query, sizeof(struct query_t), 0, deadline);
+    }
+    if (sent == -1) {
+        write_log(MIN, "Błąd wysyłania zapytania!");
+        result = errno == ETIMEDOUT ? STATUS_BUSY : -6;
+    }
+    else if (query->command == DISPLAY) {
+        struct reply_t reply;
+        struct timespec row_deadline = *deadline;
+        while (1) {
+            if (scheduler_mq_receive(reply_id, &reply, &row_deadline) != 0) {
+                write_log(MIN, "Błąd odbierania odpowiedzi z kolejki!");
+                result = -7;
+                break;
+            }
+            if (reply.status == STATUS_BUSY) {
+                result = STATUS_BUSY;
+                break;
+            }
+            // Sygnał końcowy
+            if (strlen(reply.data) == 0) {
+                break;
+            }
+            printf("%s\n", reply.data);
+            // Termin ogranicza oczekiwanie na kolejny wiersz, nie całą listę
+            scheduler_send_deadline(&row_deadline);
+        }
+    } else if (expects_reply) {
+        struct reply_t reply;
+        if (scheduler_mq_receive(reply_id, &reply, deadline) != 0) {
+            write_log(MIN, "Błąd odbierania odpowiedzi z kolejki!");
+            result = -7;
+        } else {
+            result = reply.status;
+        }
+    }
+
+    mq_close(queue_id);
+    if (reply_id != -1) {
+        mq_close(reply_id);
+        mq_unlink(query->reply_name);
+    }
+    return result;
+}
+
+// Nałożenie limitów zasobów w procesie potomnym przed exec
+static int scheduler_apply_limits(const struct task_limits_t *limits) {
+    struct rlimit limit;
+    if (limits->cpu_seconds > 0) {
+        // Miękki limit wysyła SIGXCPU, twardy sekundę później kończy proces;
+        // twardy limit nie może przekroczyć odziedziczonego
+        struct rlimit inherited;
+        getrlimit(RLIMIT_CPU, &inherited);
+        limit.rlim_cur = limits->cpu_seconds;
+        limit.rlim_max = limits->cpu_seconds + 1;
+        if (inherited.rlim_max != RLIM_INFINITY && limit.rlim_max > inherited.rlim_max) {
+            limit.rlim_max = inherited.rlim_max;
+        }
+        if (setrlimit(RLIMIT_CPU, &limit) != 0) {
+            return LIMIT_EXIT_CPU;
+        }
+    }
+    if (limits->address_space_mb > 0) {
+        limit.rlim_cur = (rlim_t)limits->address_space_mb * 1024 * 1024;
+        limit.rlim_max = limit.rlim_cur;
+        if (setrlimit(RLIMIT_AS, &limit) != 0) {
+            return LIMIT_EXIT_MEMORY;
+        }
+    }
+    if (limits->open_files > 0) {
+        limit.rlim_cur = limits->open_files;
+        limit.rlim_max = limits->open_files;
+        if (setrlimit(RLIMIT_NOFILE, &limit) != 0) {
+            return LIMIT_EXIT_FILES;
+        }
+    }
+    if (limits->nice_level != 0 && setpriority(PRIO_PROCESS, 0, limits->nice_level) != 0) {
+        return LIMIT_EXIT_NICE;
+    }
+    return 0;
+}
+
+// Maska limitów, o które prosi zadanie; kod wyjścia LIMIT_EXIT_* oznacza błąd nałożenia limitu
+// tylko wtedy, gdy jego bit jest ustawiony - w pozostałych przypadkach to zwykły kod zakończenia
+static int scheduler_limit_mask(const struct task_limits_t *limits) {
+    int mask = 0;
+    if (limits->cpu_seconds > 0) {
+        mask |= 1 << (LIMIT_EXIT_CPU - LIMIT_EXIT_CPU);
+    }
+    if (limits->address_space_mb > 0) {
+        mask |= 1 << (LIMIT_EXIT_MEMORY - LIMIT_EXIT_CPU);
+    }
+    if (limits->open_files > 0) {
+        mask |= 1 << (LIMIT_EXIT_FILES - LIMIT_EXIT_CPU);
+    }
+    if (limits->nice_level != 0) {
+        mask |= 1 << (LIMIT_EXIT_NICE - LIMIT_EXIT_CPU);
+    }
+    return mask;
+}
+
+// Uruchomienie zaplanowanego zadania (wywoływane pod task_mutex)
+pid_t scheduler_execute_task(struct task_t *task) {
+    write_log(STANDARD, "Uruchomiono zadanie %d: %s.", task->task_id, task->exec_file_name);
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Zadanie nie startuje bez limitów, o które poproszono; błąd zgłasza wątek zbierający procesy
+        int failed_limit = scheduler_apply_limits(&task->limits);
+        if (failed_limit != 0) {
+            _exit(failed_limit);
+        }
+        execlp(task->exec_file_name, task->arguments, NULL);
+        _exit(127);
+    }
+    if (pid == -1) {
+        write_log(MIN, "Błąd uruchamiania zadania %d!", task->task_id);
+        return -1;
+    }
+    scheduler_stats.launched++;
+
+    // Rejestracja instancji dla wątku zbierającego zakończone procesy
+    if (scheduler_instances.size >= scheduler_instances.capacity) {
+        int capacity = scheduler_instances.capacity > 0 ? scheduler_instances.capacity * 2 : INITIAL_CAPACITY;
+        struct instance_t *instances = realloc(scheduler_instances.instances, capacity * sizeof(struct instance_t));
+        if (instances == NULL) {
+            write_log(MIN, "Błąd alokacji pamięci dla listy instancji!");
+            return pid;
+        }
+        scheduler_instances.instances = instances;
+        scheduler_instances.capacity = capacity;
+    }
+    struct instance_t *instance = &scheduler_instances.instances[scheduler_instances.size];
+    instance->pid = pid;
+    instance->pidfd = -1;
+    instance->task_id = task->task_id;
+    instance->limit_mask = scheduler_limit_mask(&task->limits);
+    instance->sequence = ++scheduler_instance_sequence;
+    scheduler_instances.size++;
+    task->running++;
+
+    // Limit czasu egzekwowany przez kopiec terminów dyspozytora
+    if (task->limits.timeout > 0) {
+        instance->pidfd = syscall(SYS_pidfd_open, pid, 0);
+        struct deadline_t entry = { .when = time(NULL) + task->limits.timeout, .task_id = task->task_id,
+                                    .kind = DEADLINE_TERMINATE, .pid = pid, .instance = instance->sequence };
+        scheduler_schedule(&entry);
+    }
+    pthread_cond_signal(&child_cond);
+    return pid;
+}
+
+// Wysłanie sygnału do instancji przekraczającej limit czasu (wywoływane pod task_mutex)
+void scheduler_enforce_timeout(struct deadline_t *entry) {
+    struct instance_t *instance = NULL;
+    // Dopasowanie po numerze instancji - PID zakończonej instancji mógł zostać użyty ponownie
+    for (int i = 0; i < scheduler_instances.size; i++) {
+        struct instance_t *current = &scheduler_instances.instances[i];
+        if (current->pid == entry->pid && current->task_id == entry->task_id && current->sequence == entry->instance) {
+            instance = current;
+            break;
+        }
+    }
+    // Instancja już zakończona
+    if (instance == NULL) {
+        return;
+    }
+
+    int signo = entry->kind == DEADLINE_TERMINATE ? SIGTERM : SIGKILL;
+    int result;
+    if (instance->pidfd != -1) {
+        result = syscall(SYS_pidfd_send_signal, instance->pidfd, signo, NULL, 0);
+    } else {
+        result = kill(instance->pid, signo);
+    }
+    if (result != 0) {
+        write_log(MIN, "Błąd wysyłania sygnału do zadania %d (PID %d)!", entry->task_id, entry->pid);
+        return;
+    }
+
+    if (entry->kind == DEADLINE_TERMINATE) {
+        scheduler_stats.timeouts++;
+        write_log(STANDARD, "Zadanie %d (PID %d) przekroczyło limit czasu - wysłano SIGTERM.", entry->task_id, entry->pid);
+        struct deadline_t kill_entry = { .when = time(NULL) + TIMEOUT_GRACE_PERIOD, .task_id = entry->task_id,
+                                         .kind = DEADLINE_KILL, .pid = entry->pid, .instance = entry->instance };
+        scheduler_schedule(&kill_entry);
+    } else {
+        scheduler_stats.kills++;
+        write_log(STANDARD, "Zadanie %d (PID %d) nie zakończyło się po SIGTERM - wysłano SIGKILL.", entry->task_id, entry->pid);
+    }
+}
+
+// Wątek zbierający zakończone procesy i uruchamiający zadania zależne
+void *scheduler_reaper(void *arg) {
+    while (1) {
+        pthread_mutex_lock(&task_mutex);
+        while (scheduler_list != NULL && scheduler_instances.size == 0) {
+            pthread_cond_wait(&child_cond, &task_mutex);
+        }
+        if (scheduler_list == NULL) {
+            pthread_mutex_unlock(&task_mutex);
+            break;
+        }
+        pthread_mutex_unlock(&task_mutex);
+
+        // Podgląd bez zbierania - proces zbierany dopiero pod task_mutex, więc stan
+        // zapisany przy przekazaniu (HANDOVER) nie traci zakończonych instancji
+        siginfo_t info;
+        memset(&info, 0, sizeof(siginfo_t));
+        if (waitid(P_ALL, 0, &info, WEXITED | WNOWAIT) == -1) {
+            if (errno == ECHILD) {
+                // Brak procesów potomnych - instancje na liście są nieaktualne
+                pthread_mutex_lock(&task_mutex);
+                for (int i = 0; scheduler_list != NULL && i < scheduler_instances.size; i++) {
+                    if (scheduler_instances.instances[i].pidfd != -1) {
+                        close(scheduler_instances.instances[i].pidfd);
+                    }
+                    int index = scheduler_find_task(scheduler_instances.instances[i].task_id);
+                    if (index >= 0) {
+                        scheduler_list->tasks[index].running--;
+                    }
+                }
+                scheduler_instances.size = 0;
+                pthread_mutex_unlock(&task_mutex);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&task_mutex);
+        if (scheduler_list == NULL) {
+            pthread_mutex_unlock(&task_mutex);
+            break;
+        }
+        int status;
+        pid_t pid = waitpid(info.si_pid, &status, 0);
+        if (pid == -1) {
+            pthread_mutex_unlock(&task_mutex);
+            continue;
+        }
+        int task_id = -1;
+        int limit_mask = 0;
+        for (int i = 0; i < scheduler_instances.size; i++) {
+            if (scheduler_instances.instances[i].pid == pid) {
+                task_id = scheduler_instances.instances[i].task_id;
+                limit_mask = scheduler_instances.instances[i].limit_mask;
+                if (scheduler_instances.instances[i].pidfd != -1) {
+                    close(scheduler_instances.instances[i].pidfd);
+                }
+                scheduler_instances.instances[i] = scheduler_instances.instances[--scheduler_instances.size];
+                break;
+            }
+        }
+        if (task_id < 0) {
+            pthread_mutex_unlock(&task_mutex);
+            continue;
+        }
+
+        int success = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (!success) {
+            scheduler_stats.failed++;
+        }
+        if (WIFSIGNALED(status)) {
+            write_log(STANDARD, "Zadanie %d zakończone sygnałem %d.", task_id, WTERMSIG(status));
+        } else if (WEXITSTATUS(status) >= LIMIT_EXIT_CPU && WEXITSTATUS(status) <= LIMIT_EXIT_NICE &&
+                   (limit_mask & (1 << (WEXITSTATUS(status) - LIMIT_EXIT_CPU)))) {
+            static const char *limit_names[] = { "czasu procesora", "pamięci", "otwartych plików", "priorytetu" };
+            write_log(MIN, "Zadanie %d nie uruchomione - błąd nałożenia limitu %s (kod %d).", task_id,
+                      limit_names[WEXITSTATUS(status) - LIMIT_EXIT_CPU], WEXITSTATUS(status));
+        } else {
+            write_log(STANDARD, "Zadanie %d zakończone (%s).", task_id, success ? "sukces" : "błąd");
+        }
+        int index = scheduler_find_task(task_id);
+        if (index < 0) {
+            pthread_mutex_unlock(&task_mutex);
+            continue;
+        }
+        scheduler_list->tasks[index].running--;
+
+        // Zadania zależne uruchamiane bezpośrednio z tego zdarzenia
+        for (int i = 0; i < scheduler_list->tasks[index].dependents_count; i++) {
+            int dependent_index = scheduler_find_task(scheduler_list->tasks[index].dependents[i]);
+            if (dependent_index < 0) {
+                continue;
+            }
+            struct task_t *dependent = &scheduler_list->tasks[dependent_index];
+            if (!dependent->is_active || dependent->is_paused != NOT_PAUSED) {
+                continue;
+            }
+            if (dependent->trigger == ON_COMPLETION || (dependent->trigger == ON_SUCCESS && success) ||
+                (dependent->trigger == ON_FAILURE && !success)) {
+                scheduler_execute_task(dependent);
+            }
+        }
+
+        // Zadanie wycofane czekało tylko na zakończenie ostatniej instancji
+        if (!scheduler_list->tasks[index].is_active && scheduler_list->tasks[index].running == 0) {
+            scheduler_remove_task(index);
+        }
+        pthread_mutex_unlock(&task_mutex);
+    }
+    return NULL;
+}
+
+// Obsługa zegara dyspozytora - uruchomienie zadań, których termin minął
+void scheduler_dispatch(union sigval value) {
+    pthread_mutex_lock(&task_mutex);
+    if (scheduler_list == NULL) {
+        pthread_mutex_unlock(&task_mutex);
+        return;
+    }
+    time_t cur_time = time(NULL);
+    struct deadline_t entry;
+    // Wykonane zadania jednorazowe usuwane razem po obsłużeniu wszystkich terminów
+    char *marked = NULL;
+    int retired = 0;
+    while (scheduler_heap.size > 0 && scheduler_heap.entries[0].when <= cur_time) {
+        deadline_heap_pop(&scheduler_heap, &entry);
+        if (entry.kind != DEADLINE_TASK) {
+            scheduler_enforce_timeout(&entry);
+            continue;
+        }
+        int index = scheduler_find_task(entry.task_id);
+        // Wpis nieaktualny - zadanie anulowane lub przeplanowane
+        if (index < 0 || !scheduler_list->tasks[index].is_active ||
+            scheduler_list->tasks[index].execution_time != entry.when) {
+            if (scheduler_stale_entries > 0) {
+                scheduler_stale_entries--;
+            }
+            continue;
+        }
+        struct task_t *task = &scheduler_list->tasks[index];
+        // Zadanie okresowe wstrzymane pomija uruchomienie, jednorazowe czeka na wznowienie
+        if (task->is_paused != NOT_PAUSED && (task->command != PERIODIC || task->interval <= 0)) {
+            task->is_paused = PAUSED_DUE;
+            continue;
+        }
+        if (task->is_paused == NOT_PAUSED) {
+            scheduler_execute_task(task);
+        }
+        if (task->command == PERIODIC && task->interval > 0) {
+            while (task->execution_time <= cur_time) {
+                task->execution_time += task->interval;
+            }
+            entry.when = task->execution_time;
+            deadline_heap_push(&scheduler_heap, entry);
+        }
+        else {
+            if (marked == NULL) {
+                marked = calloc(scheduler_list->size, sizeof(char));
+            }
+            if (marked == NULL) {
+                write_log(MIN, "Błąd alokacji pamięci przy usuwaniu zadań!");
+                task->is_active = 0;
+                continue;
+            }
+            retired += scheduler_retire_task(index, marked);
+        }
+    }
+    if (retired > 0) {
+        scheduler_remove_marked(marked);
+    }
+    free(marked);
+    scheduler_arm_dispatcher();
+    pthread_mutex_unlock(&task_mutex);
+}
+
+// Dodanie terminu do kopca i przestawienie zegara, gdy jest najbliższy (wywoływane pod task_mutex)
+int scheduler_schedule(struct deadline_t *entry) {
+    if (deadline_heap_push(&scheduler_heap, *entry) != 0) {
+        write_log(MIN, "Błąd alokacji pamięci dla kopca terminów!");
+        return -1;
+    }
+    if (scheduler_heap.entries[0].when == entry->when && scheduler_heap.entries[0].pid == entry->pid &&
+        scheduler_heap.entries[0].task_id == entry->task_id) {
+        return scheduler_arm_dispatcher();
+    }
+    return 0;
+}
+
+// Ustawienie zegara dyspozytora na najbliższy termin (wywoływane pod task_mutex)
+int scheduler_arm_dispatcher() {
+    struct itimerspec timer_spec;
+    memset(&timer_spec, 0, sizeof(struct itimerspec));
+    if (scheduler_heap.size > 0) {
+        timer_spec.it_value.tv_sec = scheduler_heap.entries[0].when;
+        // Zerowa wartość wyłączyłaby zegar
+        if (timer_spec.it_value.tv_sec <= 0) {
+            timer_spec.it_value.tv_sec = 1;
+        }
+    }
+    if (timer_settime(dispatch_timer, TIMER_ABSTIME, &timer_spec, NULL) != 0) {
+        write_log(MIN, "Błąd timera!");
+        return -1;
+    }
+    return 0;
+}
+
+// Wyznaczenie czasu uruchomienia i okresu zadania na podstawie zapytania
+void scheduler_fill_task(struct task_t *task, struct query_t *query, time_t cur_time) {
+    strcpy(task->exec_file_name, query->exec_file_name);
+    task->command = query->command;
+    task->is_active = 1;
+    task->limits = query->limits;
+    memcpy(task->tags, query->tags, sizeof(task->tags));
+    task->tag_count = query->tag_count;
+    struct tm time_struct;
+    if (task->command == ABSOLUTE) {
+        memset(&time_struct, 0, sizeof(struct tm));
+        time_struct.tm_year = query->years - 1900;
+        time_struct.tm_mday = query->days;
+        time_struct.tm_hour = query->hours;
+        time_struct.tm_min = query->minutes;
+        time_struct.tm_sec = query->seconds;
+        time_struct.tm_isdst = -1;
+        task->execution_time = civil_mktime(&time_struct);
+    } else {
+        civil_localtime(&cur_time, &time_struct);
+        time_struct.tm_year = time_struct.tm_year + query->years;
+        time_struct.tm_mday = time_struct.tm_mday + query->days;
+        time_struct.tm_hour = time_struct.tm_hour + query->hours;
+        time_struct.tm_min = time_struct.tm_min  + query->minutes;
+        time_struct.tm_sec = time_struct.tm_sec + query->seconds;
+        task->execution_time = civil_mktime(&time_struct);
+    }
+    if (task->command == PERIODIC) {
+        task->interval = query->years * 31536000 + query->days * 86400 + query->hours * 3600 + query->minutes * 60 + query->seconds;
+    } else {
+        task->interval = 0;
+    }
+}
+
+// Dodanie zadania
+int scheduler_add_task(struct query_t *query) {
+    pthread_mutex_lock(&task_mutex);
+    struct task_t new_task;
+    memset(&new_task, 0, sizeof(struct task_t));
+    scheduler_fill_task(&new_task, query, time(NULL));
+
+    if (scheduler_list->size >= scheduler_list->capacity) {
+        if (expand_task_list(scheduler_list) != 0) {
+            pthread_mutex_unlock(&task_mutex);
+            return -4;
+        }
+    }
+    new_task.task_id = ID;
+    struct deadline_t entry = { .when = new_task.execution_time, .task_id = new_task.task_id, .kind = DEADLINE_TASK };
+    if (scheduler_schedule(&entry) != 0) {
+        pthread_mutex_unlock(&task_mutex);
+        return -3;
+    }
+    ID++;
+    scheduler_list->tasks[scheduler_list->size] = new_task;
+    scheduler_list->size++;
+    scheduler_index_tags(&new_task);
+    pthread_mutex_unlock(&task_mutex);
+    return new_task.task_id;
+}
+
+// Dodanie zadania uruchamianego po zakończeniu zadań nadrzędnych; krawędzie powstają
+// tylko razem z nowym zadaniem i prowadzą od zadań już istniejących, więc graf
+// zależności pozostaje acykliczny bez dodatkowego sprawdzania
+int scheduler_add_dependent(struct query_t *query) {
+    pthread_mutex_lock(&task_mutex);
+    // Warunek uruchomienia indeksuje tablice przy wyświetlaniu - wartość spoza zakresu jest odrzucana
+    if (query->dependency_count <= 0 || query->dependency_count > MAX_DEPENDENCIES ||
+        (int)query->trigger < ON_SUCCESS || (int)query->trigger > ON_COMPLETION) {
+        pthread_mutex_unlock(&task_mutex);
+        return -1;
+    }
+    struct task_t new_task;
+    memset(&new_task, 0, sizeof(struct task_t));
+    strcpy(new_task.exec_file_name, query->exec_file_name);
+    new_task.command = DEPENDENT;
+    new_task.trigger = query->trigger;
+    new_task.limits = query->limits;
+    memcpy(new_task.tags, query->tags, sizeof(new_task.tags));
+    new_task.tag_count = query->tag_count;
+    new_task.is_active = 1;
+    new_task.task_id = ID;
+
+    for (int i = 0; i < query->dependency_count; i++) {
+        int upstream_index = scheduler_find_task(query->dependencies[i]);
+        if (upstream_index < 0 || !scheduler_list->tasks[upstream_index].is_active) {
+            write_log(STANDARD, "Zadanie nadrzędne %d nie istnieje.", query->dependencies[i]);
+            pthread_mutex_unlock(&task_mutex);
+            return -5;
+        }
+        int duplicate = 0;
+        for (int j = 0; j < new_task.upstream_count; j++) {
+            duplicate |= new_task.upstreams[j] == query->dependencies[i];
+        }
+        if (!duplicate) {
+            new_task.upstreams[new_task.upstream_count++] = query->dependencies[i];
+        }
+    }
+
+    // Rezerwacja miejsca przed modyfikacją indeksu - błąd nie zostawia połowicznych krawędzi
+    if (scheduler_list->size >= scheduler_list->capacity) {
+        if (expand_task_list(scheduler_list) != 0) {
+            pthread_mutex_unlock(&task_mutex);
+            return -4;
+        }
+    }
+    for (int i = 0; i < new_task.upstream_count; i++) {
+        struct task_t *upstream = &scheduler_list->tasks[scheduler_find_task(new_task.upstreams[i])];
+        if (upstream->dependents_count >= upstream->dependents_capacity) {
+            int capacity = upstream->dependents_capacity > 0 ? upstream->dependents_capacity * 2 : 4;
+            int *dependents = realloc(upstream->dependents, capacity * sizeof(int));
+            if (dependents == NULL) {
+                write_log(MIN, "Błąd alokacji pamięci dla indeksu zależności!");
+                pthread_mutex_unlock(&task_mutex);
+                return -1;
+            }
+            upstream->dependents = dependents;
+            upstream->dependents_capacity = capacity;
+        }
+    }
+    for (int i = 0; i < new_task.upstream_count; i++) {
+        struct task_t *upstream = &scheduler_list->tasks[scheduler_find_task(new_task.upstreams[i])];
+        upstream->dependents[upstream->dependents_count++] = new_task.task_id;
+    }
+    ID++;
+    scheduler_list->tasks[scheduler_list->size] = new_task;
+    scheduler_list->size++;
+    scheduler_index_tags(&new_task);
+    pthread_mutex_unlock(&task_mutex);
+    return new_task.task_id;
+}
+
+// Import zadań z pliku - jedna rezerwacja pamięci i jedna budowa kopca. Import z limitem
+// (zapytanie IMPORT) parsuje tylko tyle linii, ile zadań zmieści się w limicie aktywnych zadań;
+// import przy starcie serwera przyjmuje cały plik
+int scheduler_import_tasks(const char *path, int capped) {
+    int limit = -1;
+    if (capped && scheduler_max_tasks > 0) {
+        pthread_mutex_lock(&task_mutex);
+        limit = scheduler_max_tasks > scheduler_list->size ? scheduler_max_tasks - scheduler_list->size : 0;
+        if (limit == 0) {
+            scheduler_stats.rejected++;
+        }
+        pthread_mutex_unlock(&task_mutex);
+        if (limit == 0) {
+            write_log(MIN, "Limit zadań (%d) - odrzucono import z pliku %s.", scheduler_max_tasks, path);
+            return STATUS_BUSY;
+        }
+    }
+
+    struct task_t *tasks = NULL;
+    int count = 0;
+    int rejected = 0;
+    int skipped = 0;
+    int result = import_parse_file(path, time(NULL), limit, &tasks, &count, &rejected, &skipped);
+    if (result != 0) {
+        write_log(MIN, "Błąd importu zadań z pliku %s!", path);
+        return result;
+    }
+
+    pthread_mutex_lock(&task_mutex);
+    // Zadania dodane w trakcie parsowania mogły zająć część limitu
+    if (capped && scheduler_max_tasks > 0 && scheduler_list->size + count > scheduler_max_tasks) {
+        int accepted = scheduler_max_tasks > scheduler_list->size ? scheduler_max_tasks - scheduler_list->size : 0;
+        skipped += count - accepted;
+        count = accepted;
+        if (count == 0) {
+            scheduler_stats.rejected++;
+            pthread_mutex_unlock(&task_mutex);
+            free(tasks);
+            write_log(MIN, "Limit zadań (%d) - odrzucono import z pliku %s.", scheduler_max_tasks, path);
+            return STATUS_BUSY;
+        }
+    }
+    if (reserve_task_list(scheduler_list, scheduler_list->size + count) != 0 ||
+        reserve_deadline_heap(&scheduler_heap, scheduler_heap.size + count) != 0) {
+        write_log(MIN, "Błąd alokacji pamięci dla importowanych zadań!");
+        pthread_mutex_unlock(&task_mutex);
+        free(tasks);
+        return -5;
+    }
+    for (int i = 0; i < count; i++) {
+        tasks[i].task_id = ID++;
+        scheduler_list->tasks[scheduler_list->size++] = tasks[i];
+        scheduler_index_tags(&tasks[i]);
+        struct deadline_t entry = { .when = tasks[i].execution_time, .task_id = tasks[i].task_id, .kind = DEADLINE_TASK };
+        scheduler_heap.entries[scheduler_heap.size++] = entry;
+    }
+    deadline_heap_build(&scheduler_heap);
+    scheduler_arm_dispatcher();
+    int size = scheduler_list->size;
+    pthread_mutex_unlock(&task_mutex);
+
+    free(tasks);
+    write_log(STANDARD, "Zaimportowano %d zadań z pliku %s (odrzucone linie: %d).", count, path, rejected);
+    if (skipped > 0) {
+        write_log(MIN, "Limit zadań (%d) - pominięto %d importowanych zadań z pliku %s.", scheduler_max_tasks, skipped, path);
+    }
+    if (!capped && scheduler_max_tasks > 0 && size > scheduler_max_tasks) {
+        write_log(MIN, "Import przy starcie przekroczył limit zadań %d (aktywne zadania: %d) - nowe zadania będą odrzucane.",
+                  scheduler_max_tasks, size);
+    }
+    return count;
+}
+
+// Zapis stanu harmonogramu do pliku dump (SIG_DUMP)
+void scheduler_dump(FILE *dump_file) {
+    pthread_mutex_lock(&task_mutex);
+    time_t now = time(NULL);
+    struct tm time_info;
+    char time_str[64];
+    civil_localtime(&now, &time_info);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &time_info);
+    fprintf(dump_file, "Czas wykonania zrzutu: %s\n", time_str);
+    fprintf(dump_file, "PID: %d\n", getpid());
+    if (scheduler_list != NULL) {
+        fprintf(dump_file, "Zadania: %d\n", scheduler_list->size);
+        fprintf(dump_file, "Uruchomione instancje: %d\n", scheduler_instances.size);
+    }
+    fprintf(dump_file, "Uruchomienia: %ld\n", scheduler_stats.launched);
+    fprintf(dump_file, "Zakończone błędem: %ld\n", scheduler_stats.failed);
+    fprintf(dump_file, "Przekroczone limity czasu (SIGTERM): %ld\n", scheduler_stats.timeouts);
+    fprintf(dump_file, "Wymuszone zakończenia (SIGKILL): %ld\n", scheduler_stats.kills);
+    fprintf(dump_file, "Odrzucone zapytania (przeciążenie): %ld\n", scheduler_stats.rejected);
+    pthread_mutex_unlock(&task_mutex);
+}
+
+// Indeks pierwszego zadania o identyfikatorze większym od podanego (lista posortowana po task_id)
+static int scheduler_task_after(int task_id) {
+    int low = 0;
+    int high = scheduler_list->size;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (scheduler_list->tasks[middle].task_id <= task_id) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Opis zadania w wierszu odpowiedzi DISPLAY (wywoływane pod task_mutex)
+static void scheduler_format_task(const struct task_t *task, struct reply_t *reply) {
+    char time_str[64];
+    if (task->command == DEPENDENT) {
+        static const char *triggers[] = { "sukcesie", "błędzie", "zakończeniu" };
+        int length = snprintf(time_str, sizeof(time_str), "po %s zadania", triggers[task->trigger]);
+        for (int j = 0; j < task->upstream_count && length < (int)sizeof(time_str); j++) {
+            length += snprintf(time_str + length, sizeof(time_str) - length, " %d", task->upstreams[j]);
+        }
+    } else {
+        struct tm time_info;
+        civil_localtime(&task->execution_time, &time_info);
+        strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &time_info);
+    }
+    char tags_str[MAX_TAGS * TAG_LENGTH + 16] = "";
+    for (int j = 0; j < task->tag_count; j++) {
+        strcat(tags_str, j == 0 ? " | Tagi: " : ",");
+        strcat(tags_str, task->tags[j]);
+    }
+    reply->status = 0;
+    snprintf(reply->data, sizeof(reply->data), "ID: %d | Program: %s | Czas: %s%s%s", task->task_id, task->exec_file_name,
+             time_str, tags_str, task->is_paused != NOT_PAUSED ? " | Wstrzymane" : "");
+}
+
+// Wyświetlenie listy zadań. Wiersze są kopiowane pod task_mutex porcjami po DISPLAY_CHUNK
+// i wysyłane po jego zwolnieniu - wolny klient nie blokuje harmonogramu; kolejna porcja
+// zaczyna się od pierwszego zadania za ostatnim wysłanym
+void scheduler_display_tasks(struct query_t *query) {
+    mqd_t reply_queue = -1;
+    if (query->reply_slot < 0) {
+        reply_queue = mq_open(query->reply_name, O_WRONLY);
+        if (reply_queue == -1) {
+            write_log(MIN, "Błąd otwierania kolejki odpowiedzi!");
+            return;
+        }
+    }
+    struct reply_t *rows = malloc(DISPLAY_CHUNK * sizeof(struct reply_t));
+    if (rows == NULL) {
+        write_log(MIN, "Błąd alokacji pamięci dla listy zadań!");
+        if (reply_queue != -1) {
+            mq_close(reply_queue);
+        }
+        return;
+    }
+
+    int failed = 0;
+    int last_id = -1;
+    while (!failed) {
+        pthread_mutex_lock(&task_mutex);
+        int count = 0;
+        for (int i = scheduler_task_after(last_id); i < scheduler_list->size && count < DISPLAY_CHUNK; i++) {
+            scheduler_format_task(&scheduler_list->tasks[i], &rows[count++]);
+            last_id = scheduler_list->tasks[i].task_id;
+        }
+        pthread_mutex_unlock(&task_mutex);
+        if (count == 0) {
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (scheduler_send_reply(query, reply_queue, &rows[i]) != 0) {
+                // Klient nie odbiera - przerwanie zamiast dalszego wysyłania
+                write_log(MIN, "Błąd wysyłania odpowiedzi do klienta!");
+                failed = 1;
+                break;
+            }
+            write_log(STANDARD, "%s", rows[i].data);
+        }
+    }
+    free(rows);
+
+    // Wysłanie pustej wiadomości jako sygnał końca - pominięte, gdy klient przestał odbierać
+    if (!failed) {
+        struct reply_t end_signal;
+        memset(&end_signal, 0, sizeof(struct reply_t));
+        scheduler_send_reply(query, reply_queue, &end_signal);
+    }
+
+    if (reply_queue != -1) {
+        mq_close(reply_queue);
+    }
+}
+
+// Wysłanie odpowiedzi do klienta przez kolejkę lub slot pierścienia
+// z ograniczonym czasem oczekiwania na miejsce u klienta
+int scheduler_send_reply(struct query_t *query, mqd_t reply_queue, struct reply_t *reply) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += REPLY_TIMEOUT;
+    if (query->reply_slot >= 0) {
+        if (scheduler_ring == NULL) {
+            return -1;
+        }
+        return shm_ring_reply(scheduler_ring, query->reply_slot, reply, &deadline);
+    }
+    return mq_timedsend(reply_queue, (const char *)reply, sizeof(struct reply_t), 0, &deadline);
+}
+
+// Wyszukanie zadania - lista jest uporządkowana rosnąco według task_id
+int scheduler_find_task(int task_id) {
+    int low = 0;
+    int high = scheduler_list->size - 1;
+    while (low <= high) {
+        int middle = low + (high - low) / 2;
+        int current = scheduler_list->tasks[middle].task_id;
+        if (current == task_id) {
+            return middle;
+        }
+        if (current < task_id) {
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return -1;
+}
+
+// Odłączenie zadania od grafu zależności (wywoływane pod task_mutex); zadania zależne,
+// które straciły wszystkie zadania nadrzędne, są zaznaczane do usunięcia
+static void scheduler_unlink_task(int index, char *marked, int *pending, int *pending_count) {
+    struct task_t *removed = &scheduler_list->tasks[index];
+
+    for (int i = 0; i < removed->upstream_count; i++) {
+        int upstream_index = scheduler_find_task(removed->upstreams[i]);
+        if (upstream_index < 0 || marked[upstream_index]) {
+            continue;
+        }
+        struct task_t *upstream = &scheduler_list->tasks[upstream_index];
+        for (int j = 0; j < upstream->dependents_count; j++) {
+            if (upstream->dependents[j] == removed->task_id) {
+                upstream->dependents[j] = upstream->dependents[--upstream->dependents_count];
+                break;
+            }
+        }
+    }
+
+    for (int i = 0; i < removed->dependents_count; i++) {
+        int dependent_index = scheduler_find_task(removed->dependents[i]);
+        if (dependent_index < 0 || marked[dependent_index]) {
+            continue;
+        }
+        struct task_t *dependent = &scheduler_list->tasks[dependent_index];
+        for (int j = 0; j < dependent->upstream_count; j++) {
+            if (dependent->upstreams[j] == removed->task_id) {
+                dependent->upstreams[j] = dependent->upstreams[--dependent->upstream_count];
+                break;
+            }
+        }
+        if (dependent->upstream_count > 0 || !dependent->is_active) {
+            continue;
+        }
+        if (dependent->running > 0 && dependent->dependents_count > 0) {
+            dependent->is_active = 0;
+        } else {
+            marked[dependent_index] = 1;
+            pending[(*pending_count)++] = dependent_index;
+        }
+    }
+}
+
+// Zadanie pozostaje na liście tagu, gdy nie jest zaznaczone do usunięcia (wywoływane pod task_mutex)
+static int scheduler_task_unmarked(int task_id, void *context) {
+    const char *marked = context;
+    int index = scheduler_find_task(task_id);
+    return index < 0 || !marked[index];
+}
+
+// Usunięcie nieaktualnych wpisów zadań z kopca i ponowna budowa (wywoływane pod task_mutex)
+void scheduler_compact_heap() {
+    int size = 0;
+    for (int i = 0; i < scheduler_heap.size; i++) {
+        struct deadline_t *entry = &scheduler_heap.entries[i];
+        if (entry->kind == DEADLINE_TASK) {
+            int index = scheduler_find_task(entry->task_id);
+            if (index < 0 || !scheduler_list->tasks[index].is_active ||
+                scheduler_list->tasks[index].execution_time != entry->when) {
+                continue;
+            }
+        }
+        scheduler_heap.entries[size++] = *entry;
+    }
+    write_log(MAX, "Przebudowa kopca terminów: usunięto %d nieaktualnych wpisów.", scheduler_heap.size - size);
+    scheduler_heap.size = size;
+    scheduler_stale_entries = 0;
+    deadline_heap_build(&scheduler_heap);
+    scheduler_arm_dispatcher();
+}
+
+// Usunięcie zaznaczonych zadań jednym przejściem po liście (wywoływane pod task_mutex);
+// wpisy w kopcu wygasają przy zdjęciu z kopca, a gdy przeważają nad zadaniami - kopiec jest przebudowywany
+int scheduler_remove_marked(char *marked) {
+    int *pending = malloc(scheduler_list->size * sizeof(int));
+    char *dirty_tags = calloc(scheduler_tags.capacity, sizeof(char));
+    if (pending == NULL || dirty_tags == NULL) {
+        write_log(MIN, "Błąd alokacji pamięci przy usuwaniu zadań!");
+        free(pending);
+        free(dirty_tags);
+        return -1;
+    }
+    int pending_count = 0;
+    for (int i = 0; i < scheduler_list->size; i++) {
+        if (marked[i]) {
+            pending[pending_count++] = i;
+        }
+    }
+    while (pending_count > 0) {
+        scheduler_unlink_task(pending[--pending_count], marked, pending, &pending_count);
+    }
+    free(pending);
+
+    // Lista każdego tagu usuwanych zadań filtrowana raz, zamiast wyszukiwania w niej każdego zadania
+    for (int i = 0; i < scheduler_list->size; i++) {
+        for (int j = 0; marked[i] && j < scheduler_list->tasks[i].tag_count; j++) {
+            struct tag_entry_t *entry = tag_index_find(&scheduler_tags, scheduler_list->tasks[i].tags[j]);
+            if (entry != NULL) {
+                dirty_tags[entry - scheduler_tags.entries] = 1;
             }
         }
-        else if (scheduler_query.command == DISPLAY) {
-            scheduler_display_tasks(&scheduler_query);
+    }
+    for (int i = 0; i < scheduler_tags.capacity; i++) {
+        if (dirty_tags[i]) {
+            tag_index_retain(&scheduler_tags.entries[i], scheduler_task_unmarked, marked);
         }
-        else if (scheduler_query.command == CANCEL) {
-            int result = scheduler_cancel_task(scheduler_query.task_id);
-            if ( result == 0) {
-                write_log(STANDARD, "Nie udało się usunąć zadania o numerze %d", scheduler_query.task_id);
-            }
-            else {
-                write_log(STANDARD, "Usunięto zadania o numerze %d.", scheduler_query.task_id);
+    }
+    free(dirty_tags);
+
+    int removed = 0;
+    int size = 0;
+    for (int i = 0; i < scheduler_list->size; i++) {
+        if (marked[i]) {
+            // Zadanie czekające na termin zostawia w kopcu nieaktualny wpis
+            struct task_t *task = &scheduler_list->tasks[i];
+            if (task->is_active && task->command != DEPENDENT && task->is_paused != PAUSED_DUE) {
+                scheduler_stale_entries++;
             }
-        }
-        else if (scheduler_query.command == SHUTDOWN) {
-            write_log(MAX, "Zamknięcie harmonogramu.");
-            scheduler_shutdown(queue_id);
-            break;
-        }
-        else {
-            write_log(MIN, "Błędna komenda!");
+            free(task->dependents);
+            removed++;
+        } else {
+            scheduler_list->tasks[size++] = scheduler_list->tasks[i];
         }
     }
-    return 0;
+    scheduler_list->size = size;
+    if (scheduler_stale_entries > INITIAL_CAPACITY && scheduler_stale_entries > scheduler_list->size) {
+        scheduler_compact_heap();
+    }
+    return removed;
 }
 
-// Klient
-int scheduler_client(int argc, char **argv) {
-    struct query_t scheduler_query;
-    int arguments = handle_program_arguments(argc, argv, &scheduler_query);
-    if (arguments != 0) {
-        return arguments;
+// Usunięcie zadania z listy (wywoływane pod task_mutex)
+void scheduler_remove_task(int index) {
+    char *marked = calloc(scheduler_list->size, sizeof(char));
+    if (marked == NULL) {
+        write_log(MIN, "Błąd alokacji pamięci przy usuwaniu zadań!");
+        return;
     }
+    marked[index] = 1;
+    scheduler_remove_marked(marked);
+    free(marked);
+}
 
-    mqd_t queue_id = mq_open(QUEUE_NAME, O_WRONLY);
-    if (queue_id == -1) {
-        write_log(MIN, "Błąd otwierania kolejki!");
-        return -4;
+// Wycofanie wykonanego zadania - zaznaczenie do usunięcia (zwraca 1); zadanie z uruchomioną
+// instancją i zależnymi czeka na jej zakończenie (zwraca 0)
+int scheduler_retire_task(int index, char *marked) {
+    struct task_t *task = &scheduler_list->tasks[index];
+    // Wpis w kopcu został już zdjęty - zadanie nie zostawia nieaktualnego wpisu
+    task->is_active = 0;
+    if (task->running > 0 && task->dependents_count > 0) {
+        return 0;
     }
+    marked[index] = 1;
+    return 1;
+}
 
-    mqd_t reply_id;
-    if (scheduler_query.command == DISPLAY) {
-        sprintf(scheduler_query.reply_name, "/reply_queue_%d", getpid());
-        struct mq_attr reply_attr;
-        reply_attr.mq_flags = 0;
-        reply_attr.mq_maxmsg = INITIAL_CAPACITY;
-        reply_attr.mq_msgsize = sizeof(struct reply_t);
-        reply_attr.mq_curmsgs = 0;
-
-        reply_id = mq_open(scheduler_query.reply_name, O_RDONLY | O_CREAT | O_EXCL, 0666, &reply_attr);
-        if (reply_id == -1) {
-            mq_close(queue_id);
-            write_log(MIN, "Błąd tworzenia kolejki odpowiedzi!");
-            return -5;
+// Zaznaczenie zadań wskazanych identyfikatorem, tagiem lub wzorcem nazwy (wywoływane pod task_mutex)
+int scheduler_select_tasks(struct query_t *query, char *marked) {
+    int count = 0;
+    if (query->selector == BY_ID) {
+        int index = scheduler_find_task(query->task_id);
+        if (index >= 0 && scheduler_list->tasks[index].is_active) {
+            marked[index] = 1;
+            count++;
         }
     }
-
-    if (mq_send(queue_id, (const char*)&scheduler_query, sizeof(struct query_t), 0) == -1) {
-        write_log(MIN, "Błąd wysyłania zapytania!");
-        mq_close(queue_id);
-        return -6;
-    }
-
-    if (scheduler_query.command == DISPLAY) {
-        struct reply_t reply;
-        while (1) {
-            if (mq_receive(reply_id, (char *)&reply, sizeof(struct reply_t), NULL) == -1) {
-                write_log(MIN, "Błąd odbierania odpowiedzi z kolejki!");
-                break;
+    else if (query->selector == BY_TAG) {
+        struct tag_entry_t *entry = tag_index_find(&scheduler_tags, query->tags[0]);
+        for (int i = 0; entry != NULL && i < entry->size; i++) {
+            int index = scheduler_find_task(entry->task_ids[i]);
+            if (index >= 0 && !marked[index] && scheduler_list->tasks[index].is_active) {
+                marked[index] = 1;
+                count++;
             }
-            // Sygnał końcowy
-            if (strlen(reply.data) == 0) {
-                break;
+        }
+    }
+    else {
+        for (int i = 0; i < scheduler_list->size; i++) {
+            if (scheduler_list->tasks[i].is_active && fnmatch(query->exec_file_name, scheduler_list->tasks[i].exec_file_name, 0) == 0) {
+                marked[i] = 1;
+                count++;
             }
-            printf("%s\n", reply.data);
         }
-    } else {
-        mq_close(queue_id);
-        return 0;
     }
-
-    mq_close(queue_id);
-    mq_close(reply_id);
-    mq_unlink(scheduler_query.reply_name);
-    return 0;
+    return count;
 }
 
-// Uruchomienie zaplanowanego zadania
-void *scheduler_execute_task(void *new_task) {
-    struct task_t *task = (struct task_t*) new_task;
-    if (task == NULL) {
-        return NULL;
+// Anulowanie, wstrzymanie lub wznowienie wskazanych zadań pod jedną blokadą; zwraca liczbę zadań
+int scheduler_bulk_update(struct query_t *query) {
+    pthread_mutex_lock(&task_mutex);
+    char *marked = calloc(scheduler_list->size > 0 ? scheduler_list->size : 1, sizeof(char));
+    if (marked == NULL) {
+        write_log(MIN, "Błąd alokacji pamięci przy wyborze zadań!");
+        pthread_mutex_unlock(&task_mutex);
+        return -1;
     }
-    write_log(STANDARD, "Uruchomiono zadanie %d: %s.", task->task_id, task->exec_file_name);
-    if (!fork()) {
-        execlp(task->exec_file_name, task->arguments, NULL);
+    int count = scheduler_select_tasks(query, marked);
+    if (query->command == CANCEL) {
+        if (count > 0 && scheduler_remove_marked(marked) < 0) {
+            count = -1;
+        }
     }
-    if (task->command == RELATIVE || task->command == ABSOLUTE) {
-        scheduler_cancel_task(task->task_id);
+    else {
+        time_t cur_time = time(NULL);
+        for (int i = 0; i < scheduler_list->size; i++) {
+            if (!marked[i]) {
+                continue;
+            }
+            struct task_t *task = &scheduler_list->tasks[i];
+            if (query->command == PAUSE) {
+                if (task->is_paused == NOT_PAUSED) {
+                    task->is_paused = PAUSED;
+                }
+                continue;
+            }
+            // Termin pominięty podczas wstrzymania - ponowne zaplanowanie
+            if (task->is_paused == PAUSED_DUE) {
+                if (task->execution_time < cur_time) {
+                    task->execution_time = cur_time;
+                }
+                struct deadline_t entry = { .when = task->execution_time, .task_id = task->task_id, .kind = DEADLINE_TASK };
+                scheduler_schedule(&entry);
+            }
+            task->is_paused = NOT_PAUSED;
+        }
     }
-    return NULL;
+    free(marked);
+    pthread_mutex_unlock(&task_mutex);
+    return count;
 }
 
-// Dodanie zadania
-int scheduler_add_task(struct query_t *query) {
-    pthread_mutex_lock(&task_mutex);
-    struct task_t *new_task = calloc(1, sizeof(struct task_t));
-    if (new_task == NULL) {
-        write_log(MIN, "Błąd alokacji pamięci dla nowego zadania!");
-        pthread_mutex_unlock(&task_mutex);
-        return -1;
+// Dodanie zadania do indeksu tagów (wywoływane pod task_mutex)
+int scheduler_index_tags(struct task_t *task) {
+    for (int i = 0; i < task->tag_count; i++) {
+        if (tag_index_add(&scheduler_tags, task->tags[i], task->task_id) != 0) {
+            write_log(MIN, "Błąd alokacji pamięci dla indeksu tagów!");
+            return -1;
+        }
     }
+    return 0;
+}
 
-    strcpy(new_task->exec_file_name, query->exec_file_name);
-    new_task->command = query->command;
-    new_task->task_id = ID++;
-    new_task->is_active = 1;
-    time_t cur_time = time(NULL);
-    struct tm time_struct;
-    time_t exec_time;
-    if (new_task->command == ABSOLUTE) {
-        memset(&time_struct, 0, sizeof(struct tm));
-        time_struct.tm_year = query->years - 1900;
-        time_struct.tm_mday = query->days;
-        time_struct.tm_hour = query->hours;
-        time_struct.tm_min = query->minutes;
-        time_struct.tm_sec = query->seconds;
-        time_struct.tm_isdst = -1;
-        exec_time = mktime(&time_struct);
-    } else {
-        localtime_r(&cur_time, &time_struct);
-        time_struct.tm_year = time_struct.tm_year + query->years;
-        time_struct.tm_mday = time_struct.tm_mday + query->days;
-        time_struct.tm_hour = time_struct.tm_hour + query->hours;
-        time_struct.tm_min = time_struct.tm_min  + query->minutes;
-        time_struct.tm_sec = time_struct.tm_sec + query->seconds;
-        exec_time = mktime(&time_struct);
+// Zapis stanu harmonogramu do pliku (wywoływane pod task_mutex)
+int scheduler_save_state(int fd) {
+    long dependents_total = 0;
+    for (int i = 0; i < scheduler_list->size; i++) {
+        dependents_total += scheduler_list->tasks[i].dependents_count;
     }
-    new_task->execution_time = exec_time;
+    struct handover_header_t header;
+    memset(&header, 0, sizeof(struct handover_header_t));
+    header.magic = HANDOVER_MAGIC;
+    header.version = HANDOVER_VERSION;
+    header.header_size = sizeof(struct handover_header_t);
+    header.task_size = sizeof(struct task_t);
+    header.deadline_size = sizeof(struct deadline_t);
+    header.instance_size = sizeof(struct instance_t);
+    header.next_id = ID;
+    header.next_instance = scheduler_instance_sequence;
+    header.task_count = scheduler_list->size;
+    header.heap_count = scheduler_heap.size;
+    header.instance_count = scheduler_instances.size;
+    header.dependents_total = dependents_total;
+    header.stats = scheduler_stats;
 
-    struct sigevent sev;
-    sev.sigev_notify = SIGEV_THREAD;
-    sev.sigev_notify_function = (void*)scheduler_execute_task;
-    sev.sigev_value.sival_ptr = new_task;
-    sev.sigev_notify_attributes = NULL;
-    if (timer_create(CLOCK_REALTIME, &sev, &new_task->timer) != 0) {
-        write_log(MIN, "Błąd timera!");
-        free(new_task);
-        pthread_mutex_unlock(&task_mutex);
+    size_t tasks_size = header.task_count * sizeof(struct task_t);
+    size_t heap_size = header.heap_count * sizeof(struct deadline_t);
+    size_t instances_size = header.instance_count * sizeof(struct instance_t);
+    size_t total = sizeof(header) + tasks_size + heap_size + instances_size + dependents_total * sizeof(int);
+    if (ftruncate(fd, total) != 0) {
+        return -1;
+    }
+    char *state = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (state == MAP_FAILED) {
         return -2;
     }
 
-    struct itimerspec timer_spec;
-    timer_spec.it_value.tv_sec = new_task->execution_time - cur_time;
-    timer_spec.it_value.tv_nsec = 0;
-    if (new_task->command == PERIODIC) {
-        time_t interval = query->years * 31536000 + query->days * 86400 + query->hours * 3600 + query->minutes * 60 + query->seconds;
-        timer_spec.it_interval.tv_sec = interval;
-    } else {
-        timer_spec.it_interval.tv_sec = 0;
+    // Tablice kopiowane w całości; listy zależnych dopisywane w kolejności zadań
+    char *position = state;
+    memcpy(position, &header, sizeof(header));
+    position += sizeof(header);
+    memcpy(position, scheduler_list->tasks, tasks_size);
+    position += tasks_size;
+    memcpy(position, scheduler_heap.entries, heap_size);
+    position += heap_size;
+    memcpy(position, scheduler_instances.instances, instances_size);
+    position += instances_size;
+    for (int i = 0; i < scheduler_list->size; i++) {
+        size_t size = scheduler_list->tasks[i].dependents_count * sizeof(int);
+        if (size > 0) {
+            memcpy(position, scheduler_list->tasks[i].dependents, size);
+            position += size;
+        }
     }
-    timer_spec.it_interval.tv_nsec = 0;
+    munmap(state, total);
+    return 0;
+}
 
-    if (timer_settime(new_task->timer, 0, &timer_spec, NULL) != 0) {
-        write_log(MIN, "Błąd timera!");
-        timer_delete(new_task->timer);
-        free(new_task);
-        pthread_mutex_unlock(&task_mutex);
+// Odtworzenie stanu harmonogramu z pliku; zwraca liczbę zadań
+int scheduler_restore_state(int fd) {
+    struct stat state_stat;
+    if (fstat(fd, &state_stat) != 0 || state_stat.st_size < (off_t)sizeof(struct handover_header_t)) {
+        return -1;
+    }
+    size_t total = state_stat.st_size;
+    char *state = mmap(NULL, total, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (state == MAP_FAILED) {
+        return -2;
+    }
+    struct handover_header_t header;
+    memcpy(&header, state, sizeof(header));
+    // Stan zapisany w innym formacie nie jest odczytywany - nawet przy zgodnej łącznej długości
+    if (header.magic != HANDOVER_MAGIC || header.version != HANDOVER_VERSION ||
+        header.header_size != sizeof(struct handover_header_t) || header.task_size != sizeof(struct task_t) ||
+        header.deadline_size != sizeof(struct deadline_t) || header.instance_size != sizeof(struct instance_t)) {
+        munmap(state, total);
+        return -3;
+    }
+    size_t tasks_size = header.task_count * sizeof(struct task_t);
+    size_t heap_size = header.heap_count * sizeof(struct deadline_t);
+    size_t instances_size = header.instance_count * sizeof(struct instance_t);
+    if (header.task_count < 0 || header.heap_count < 0 || header.instance_count < 0 || header.dependents_total < 0 ||
+        total != sizeof(header) + tasks_size + heap_size + instances_size + header.dependents_total * sizeof(int)) {
+        munmap(state, total);
         return -3;
     }
 
-    if (scheduler_list->size >= scheduler_list->capacity) {
-        if (expand_task_list(scheduler_list) != 0) {
-            free(new_task);
+    pthread_mutex_lock(&task_mutex);
+    if (reserve_task_list(scheduler_list, header.task_count) != 0 ||
+        reserve_deadline_heap(&scheduler_heap, header.heap_count) != 0) {
+        pthread_mutex_unlock(&task_mutex);
+        munmap(state, total);
+        return -4;
+    }
+    if (header.instance_count > 0) {
+        scheduler_instances.instances = malloc(instances_size);
+        if (scheduler_instances.instances == NULL) {
             pthread_mutex_unlock(&task_mutex);
+            munmap(state, total);
             return -4;
         }
+        scheduler_instances.capacity = header.instance_count;
     }
-    scheduler_list->tasks[scheduler_list->size] = *new_task;
-    scheduler_list->size++;
-    pthread_mutex_unlock(&task_mutex);
-    return new_task->task_id;
-}
 
-// Wyświetlenie listy zadań
-void scheduler_display_tasks(struct query_t *query) {
-    pthread_mutex_lock(&task_mutex);
-    mqd_t reply_queue = mq_open(query->reply_name, O_WRONLY);
-    if (reply_queue == -1) {
-        write_log(MIN, "Błąd otwierania kolejki odpowiedzi!");
-        pthread_mutex_unlock(&task_mutex);
-        return;
-    }
+    const char *position = state + sizeof(header);
+    memcpy(scheduler_list->tasks, position, tasks_size);
+    scheduler_list->size = header.task_count;
+    position += tasks_size;
+    // Kopiec zapisany w porządku kopca - bez ponownej budowy
+    memcpy(scheduler_heap.entries, position, heap_size);
+    scheduler_heap.size = header.heap_count;
+    position += heap_size;
+    memcpy(scheduler_instances.instances, position, instances_size);
+    scheduler_instances.size = header.instance_count;
+    position += instances_size;
 
     for (int i = 0; i < scheduler_list->size; i++) {
         struct task_t *task = &scheduler_list->tasks[i];
-        char time_str[26];
-        struct tm *time_info = localtime(&task->execution_time);
-        strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", time_info);
-        struct reply_t reply;
-        snprintf(reply.data, sizeof(reply.data), "ID: %d | Program: %s | Czas: %s", task->task_id, task->exec_file_name, time_str);
-
-        if (mq_send(reply_queue, (const char *)&reply, sizeof(struct reply_t), 0) == -1) {
-            write_log(MIN, "Błąd wysyłania odpowiedzi do klienta!");
-        } else {
-            write_log(STANDARD, "%s", reply.data);
+        task->dependents = NULL;
+        task->dependents_capacity = 0;
+        if (task->dependents_count > 0) {
+            size_t size = task->dependents_count * sizeof(int);
+            task->dependents = malloc(size);
+            if (task->dependents == NULL) {
+                write_log(MIN, "Błąd alokacji pamięci dla indeksu zależności!");
+                task->dependents_count = 0;
+            } else {
+                memcpy(task->dependents, position, size);
+                task->dependents_capacity = task->dependents_count;
+            }
+            position += size;
         }
+        scheduler_index_tags(task);
     }
 
-    // Wysłanie pustej wiadomości jako sygnał końca
-    struct reply_t end_signal;
-    memset(&end_signal, 0, sizeof(struct reply_t));
-    mq_send(reply_queue, (const char *)&end_signal, sizeof(struct reply_t), 0);
+    // Procesy potomne pozostają dziećmi tego samego procesu - nowe deskryptory pidfd
+    for (int i = 0; i < scheduler_instances.size; i++) {
+        if (scheduler_instances.instances[i].pidfd != -1) {
+            scheduler_instances.instances[i].pidfd = syscall(SYS_pidfd_open, scheduler_instances.instances[i].pid, 0);
+        }
+    }
+    ID = header.next_id;
+    scheduler_instance_sequence = header.next_instance;
+    scheduler_stats = header.stats;
 
-    mq_close(reply_queue);
+    // Terminy, które minęły podczas przekazania, zostaną obsłużone od razu
+    scheduler_arm_dispatcher();
+    pthread_cond_signal(&child_cond);
     pthread_mutex_unlock(&task_mutex);
+    munmap(state, total);
+    return header.task_count;
+}
+
+// Opis formatu stanu przekazywanego przez HANDOVER: wersja i rozmiary zapisywanych struktur
+// oraz przejmowanych bez zmian kolejki i pierścienia
+void scheduler_handover_signature(char *signature, size_t size) {
+    snprintf(signature, size, "%x:%u:%zu:%zu:%zu:%zu:%zu:%zu", HANDOVER_MAGIC, HANDOVER_VERSION,
+             sizeof(struct handover_header_t), sizeof(struct task_t), sizeof(struct deadline_t),
+             sizeof(struct instance_t), sizeof(struct query_t), sizeof(struct shm_ring_t));
+}
+
+// Odpowiedź nowego pliku wykonywalnego na sprawdzenie zgodności (--handover-check): własny opis formatu
+// na standardowym wyjściu; 0 - zgodny z opisem przekazanym przez serwer
+int scheduler_handover_check(const char *signature) {
+    char own[128];
+    scheduler_handover_signature(own, sizeof(own));
+    printf("%s\n", own);
+    return strcmp(own, signature) == 0 ? 0 : -1;
+}
+
+// Uruchomienie nowego pliku wykonywalnego w trybie sprawdzenia zgodności i oczekiwanie na potwierdzenie;
+// potwierdzeniem jest identyczny opis formatu i kod 0 - sam kod wyjścia spełni dowolny program.
+// Wywoływane pod task_mutex - wątek zbierający nie odbierze statusu procesu sprawdzającego.
+static int scheduler_check_binary(const char *binary) {
+    char signature[128];
+    scheduler_handover_signature(signature, sizeof(signature));
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        close(pipe_fds[0]);
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        execl(binary, binary, "--handover-check", signature, (char *)NULL);
+        _exit(127);
+    }
+    close(pipe_fds[1]);
+
+    char answer[128];
+    size_t received = 0;
+    int result = -3;
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += HANDOVER_CHECK_TIMEOUT;
+    while (received < sizeof(answer) - 1) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int remaining = (deadline.tv_sec - now.tv_sec) * 1000 + (deadline.tv_nsec - now.tv_nsec) / 1000000;
+        struct pollfd answer_poll = { pipe_fds[0], POLLIN, 0 };
+        if (remaining <= 0 || poll(&answer_poll, 1, remaining) <= 0) {
+            break;
+        }
+        ssize_t bytes = read(pipe_fds[0], answer + received, sizeof(answer) - 1 - received);
+        if (bytes <= 0) {
+            // Koniec danych - proces zakończył pracę
+            result = -2;
+            break;
+        }
+        received += bytes;
+    }
+    close(pipe_fds[0]);
+    answer[received] = '\0';
+
+    int status;
+    if (result == -3) {
+        kill(pid, SIGKILL);
+    }
+    if (waitpid(pid, &status, 0) != pid) {
+        return -1;
+    }
+    if (result == -3) {
+        return -3;
+    }
+    size_t length = strlen(signature);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || received != length + 1 ||
+        strncmp(answer, signature, length) != 0 || answer[length] != '\n') {
+        return -2;
+    }
+    return 0;
 }
 
-// Anulowanie zadania
-int scheduler_cancel_task(int task_id) {
+// Przekazanie pracy nowemu plikowi wykonywalnemu bez zamykania kolejki i pierścienia
+void scheduler_handover(mqd_t queue_id, struct query_t *query) {
+    // Bieżący plik wykonywalny - powrót, gdy nowy nie odczyta stanu; ścieżka rozwinięta, aby zachować nazwę procesu
+    char current[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", current, sizeof(current) - 1);
+    if (length <= 0) {
+        strcpy(current, "/proc/self/exe");
+    } else {
+        current[length] = '\0';
+    }
+    const char *binary = query->exec_file_name[0] != '\0' ? query->exec_file_name : current;
+    write_log(MAX, "Przekazanie harmonogramu do %s.", binary);
+
+    // Wątek pierścienia kończy pracę, zapytania zostają w pamięci współdzielonej
+    if (scheduler_ring != NULL) {
+        shm_ring_interrupt(scheduler_ring);
+        pthread_join(ring_thread, NULL);
+    }
+
     pthread_mutex_lock(&task_mutex);
-    for (int i = 0; i < scheduler_list->size; i++) {
-        if (scheduler_list->tasks[i].task_id == task_id) {
-            timer_delete(scheduler_list->tasks[i].timer);
-            for (int j = i; j < scheduler_list->size - 1; j++) {
-                scheduler_list->tasks[j] = scheduler_list->tasks[j + 1];
+    int state_fd = -1;
+    int check = scheduler_check_binary(binary);
+    if (check != 0) {
+        write_log(MIN, "Plik %s nie potwierdził zgodności stanu (kod %d) - harmonogram pracuje dalej.", binary, check);
+    }
+    else if ((state_fd = syscall(SYS_memfd_create, "scheduler_state", 0)) == -1 || scheduler_save_state(state_fd) != 0) {
+        write_log(MIN, "Błąd zapisu stanu harmonogramu!");
+    }
+    else {
+        char state_arg[16];
+        char queue_arg[16];
+        sprintf(state_arg, "%d", state_fd);
+        sprintf(queue_arg, "%d", (int)queue_id);
+        int queue_flags = fcntl(queue_id, F_GETFD);
+        fcntl(queue_id, F_SETFD, queue_flags & ~FD_CLOEXEC);
+        for (int i = 0; i < scheduler_instances.size; i++) {
+            if (scheduler_instances.instances[i].pidfd != -1) {
+                close(scheduler_instances.instances[i].pidfd);
+            }
+        }
+
+        // Blokada task_mutex trwa do exec - stan nie zmienia się po zapisie
+        execl(binary, binary, "--resume", state_arg, queue_arg, current, (char *)NULL);
+
+        write_log(MIN, "Błąd uruchamiania %s - harmonogram pracuje dalej.", binary);
+        fcntl(queue_id, F_SETFD, queue_flags);
+        for (int i = 0; i < scheduler_instances.size; i++) {
+            if (scheduler_instances.instances[i].pidfd != -1) {
+                scheduler_instances.instances[i].pidfd = syscall(SYS_pidfd_open, scheduler_instances.instances[i].pid, 0);
             }
-            scheduler_list->size--;
-            pthread_mutex_unlock(&task_mutex);
-            return 1;
         }
     }
+    if (state_fd != -1) {
+        close(state_fd);
+    }
     pthread_mutex_unlock(&task_mutex);
-    return 0;
+
+    if (scheduler_ring != NULL) {
+        atomic_store(&scheduler_ring->interrupted, 0);
+        if (pthread_create(&ring_thread, NULL, scheduler_ring_worker, NULL) != 0) {
+            write_log(MIN, "Błąd uruchamiania wątku pierścienia zapytań!");
+            shm_ring_destroy(scheduler_ring);
+            scheduler_ring = NULL;
+        }
+    }
 }
 
 // Zakończenie pracy programu
 void scheduler_shutdown(mqd_t queue_id) {
+    if (scheduler_ring != NULL) {
+        shm_ring_close(scheduler_ring);
+        pthread_join(ring_thread, NULL);
+        shm_ring_destroy(scheduler_ring);
+        scheduler_ring = NULL;
+    }
     pthread_mutex_lock(&task_mutex);
+    timer_delete(dispatch_timer);
+    free_deadline_heap(&scheduler_heap);
+    free_tag_index(&scheduler_tags);
     for (int i = 0; i < scheduler_list->size; i++) {
-        timer_delete(scheduler_list->tasks[i].timer);
+        free(scheduler_list->tasks[i].dependents);
+    }
+    for (int i = 0; i < scheduler_instances.size; i++) {
+        if (scheduler_instances.instances[i].pidfd != -1) {
+            close(scheduler_instances.instances[i].pidfd);
+        }
     }
+    free(scheduler_instances.instances);
+    scheduler_instances.instances = NULL;
+    scheduler_instances.size = 0;
+    scheduler_instances.capacity = 0;
+    pthread_cond_signal(&child_cond);
     free_task_list(scheduler_list);
+    free(scheduler_list);
     scheduler_list = NULL;
     mq_close(queue_id);
     mq_unlink(QUEUE_NAME);
     pthread_mutex_unlock(&task_mutex);
 }
 
+// Rozwinięcie ścieżki do postaci bezwzględnej w polu zapytania; -1 gdy wynik się nie mieści
+static int resolve_query_path(const char *path, char *field, size_t size) {
+    char resolved[PATH_MAX];
+    const char *source = realpath(path, resolved) != NULL ? resolved : path;
+    if (strlen(source) >= size) {
+        return -1;
+    }
+    strcpy(field, source);
+    return 0;
+}
+
 // Obsługa argumenßów programu
 int handle_program_arguments(int argc, char** argv, struct query_t *query) {
+    if (handle_task_options(&argc, argv, query) != 0) {
+        return -2;
+    }
     if (argc < 2) {
         return -1;
     }
@@ -380,25 +2216,130 @@ int handle_program_arguments(int argc, char** argv, struct query_t *query) {
         query->seconds = atoi(argv[6]);
         strcpy(query->exec_file_name, argv[7]);
     }
+    else if (strcmp(argv[1], "DEPENDENT") == 0) {
+        if (argc < 5 || argc - 4 > MAX_DEPENDENCIES) {
+            return -2;
+        }
+        query->command = DEPENDENT;
+        if (strcmp(argv[2], "SUCCESS") == 0) {
+            query->trigger = ON_SUCCESS;
+        }
+        else if (strcmp(argv[2], "FAILURE") == 0) {
+            query->trigger = ON_FAILURE;
+        }
+        else if (strcmp(argv[2], "COMPLETION") == 0) {
+            query->trigger = ON_COMPLETION;
+        }
+        else {
+            return -3;
+        }
+        strcpy(query->exec_file_name, argv[3]);
+        query->dependency_count = argc - 4;
+        for (int i = 0; i < query->dependency_count; i++) {
+            query->dependencies[i] = atoi(argv[4 + i]);
+        }
+    }
     else if (strcmp(argv[1], "DISPLAY") == 0) {
         query->command = DISPLAY;
     }
     else if (strcmp(argv[1], "CANCEL") == 0) {
-        if (argc < 3) {
-            return -2;
-        }
         query->command = CANCEL;
-        query->task_id = atoi(argv[2]);
+        return handle_selector(argc, argv, query);
+    }
+    else if (strcmp(argv[1], "PAUSE") == 0) {
+        query->command = PAUSE;
+        return handle_selector(argc, argv, query);
+    }
+    else if (strcmp(argv[1], "RESUME") == 0) {
+        query->command = RESUME;
+        return handle_selector(argc, argv, query);
     }
     else if (strcmp(argv[1], "SHUTDOWN") == 0) {
         query->command = SHUTDOWN;
     }
+    else if (strcmp(argv[1], "HANDOVER") == 0) {
+        query->command = HANDOVER;
+        if (argc >= 3 && resolve_query_path(argv[2], query->exec_file_name, sizeof(query->exec_file_name)) != 0) {
+            return -2;
+        }
+    }
+    else if (strcmp(argv[1], "IMPORT") == 0) {
+        // Serwer może mieć inny katalog roboczy niż klient
+        if (argc < 3 || resolve_query_path(argv[2], query->exec_file_name, sizeof(query->exec_file_name)) != 0) {
+            return -2;
+        }
+        query->command = IMPORT;
+    }
     else {
         return -3;
     }
     return 0;
 }
 
+// Obsługa wskazania zadań: task_id | TAG tag | NAME wzorzec
+int handle_selector(int argc, char** argv, struct query_t *query) {
+    if (argc < 3) {
+        return -2;
+    }
+    if (strcmp(argv[2], "TAG") == 0 || strcmp(argv[2], "NAME") == 0) {
+        if (argc < 4) {
+            return -2;
+        }
+        if (strcmp(argv[2], "TAG") == 0) {
+            if (strlen(argv[3]) >= TAG_LENGTH) {
+                return -2;
+            }
+            query->selector = BY_TAG;
+            strcpy(query->tags[0], argv[3]);
+            query->tag_count = 1;
+        } else {
+            if (strlen(argv[3]) >= sizeof(query->exec_file_name)) {
+                return -2;
+            }
+            query->selector = BY_NAME;
+            strcpy(query->exec_file_name, argv[3]);
+        }
+        return 0;
+    }
+    query->selector = BY_ID;
+    query->task_id = atoi(argv[2]);
+    return 0;
+}
+
+// Obsługa opcji zadania (--timeout, --cpu, --memory, --files, --nice, --tag);
+// rozpoznane opcje są usuwane z argv
+int handle_task_options(int *argc, char** argv, struct query_t *query) {
+    static const char *options[] = { "--timeout", "--cpu", "--memory", "--files", "--nice" };
+    int *values[] = { &query->limits.timeout, &query->limits.cpu_seconds, &query->limits.address_space_mb,
+                      &query->limits.open_files, &query->limits.nice_level };
+    int count = 0;
+    for (int i = 0; i < *argc; i++) {
+        int option = -1;
+        for (int j = 0; j < 5; j++) {
+            if (strcmp(argv[i], options[j]) == 0) {
+                option = j;
+            }
+        }
+        if (strcmp(argv[i], "--tag") == 0) {
+            if (i + 1 >= *argc || query->tag_count >= MAX_TAGS || strlen(argv[i + 1]) >= TAG_LENGTH) {
+                return -1;
+            }
+            strcpy(query->tags[query->tag_count++], argv[++i]);
+            continue;
+        }
+        if (option < 0) {
+            argv[count++] = argv[i];
+            continue;
+        }
+        if (i + 1 >= *argc) {
+            return -1;
+        }
+        *values[option] = atoi(argv[++i]);
+    }
+    *argc = count;
+    return 0;
+}
+
 // Inicjalizacja listy zadań
 int init_task_list(struct task_list_t *list) {
     if (list == NULL) {
@@ -427,6 +2368,23 @@ int expand_task_list(struct task_list_t *list) {
     return 0;
 }
 
+// Zapewnienie miejsca na co najmniej capacity zadań jedną realokacją
+int reserve_task_list(struct task_list_t *list, int capacity) {
+    if (list == NULL || list->tasks == NULL) {
+        return -1;
+    }
+    if (capacity <= list->capacity) {
+        return 0;
+    }
+    struct task_t *new_tasks = (struct task_t *)realloc(list->tasks, capacity * sizeof(struct task_t));
+    if (new_tasks == NULL) {
+        return -2;
+    }
+    list->tasks = new_tasks;
+    list->capacity = capacity;
+    return 0;
+}
+
 // Zwalnianie pamięci listy zadań
 void free_task_list(struct task_list_t *list) {
     if (list == NULL) {
@@ -3,9 +3,50 @@
 
 #include <time.h>
 #include <mqueue.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include "deadline_heap.h"
+#include "tag_index.h"
 
 #define QUEUE_NAME "/mq_query_queue"
 #define INITIAL_CAPACITY 10
+#define MAX_DEPENDENCIES 8
+#define TIMEOUT_GRACE_PERIOD 5
+// Kody wyjścia procesu potomnego, gdy nie udało się nałożyć limitu
+#define LIMIT_EXIT_CPU 121
+#define LIMIT_EXIT_MEMORY 122
+#define LIMIT_EXIT_FILES 123
+#define LIMIT_EXIT_NICE 124
+#define MAX_TAGS 4
+#define HANDOVER_MAGIC 0x48414e44
+// Wersja formatu stanu przekazywanego przez HANDOVER - zmieniana przy każdej zmianie zapisu
+#define HANDOVER_VERSION 3
+// Czas (s) na potwierdzenie zgodności przez nowy plik wykonywalny przed exec
+#define HANDOVER_CHECK_TIMEOUT 5
+
+// Kontrola przyjmowania zapytań
+// Limit aktywnych zadań (0 - bez limitu), nadpisywany zmienną środowiskową serwera;
+// nie dotyczy importu przy starcie serwera
+#define MAX_LIVE_TASKS 100000
+#define MAX_TASKS_ENV "SCHEDULER_MAX_TASKS"
+#define QUEUE_HIGH_WATERMARK 8
+#define RATE_LIMIT_CLIENTS 64
+// Limit zapytań kolejki na UID w oknie (0 - bez limitu), nadpisywany zmienną środowiskową serwera;
+// sesje pierścienia ogranicza jego pojemność
+#define RATE_LIMIT_REQUESTS 1000
+#define RATE_LIMIT_ENV "SCHEDULER_RATE_LIMIT"
+#define RATE_LIMIT_WINDOW 1
+#define REPLY_TIMEOUT 1
+// Liczba wierszy DISPLAY kopiowanych pod task_mutex przed wysłaniem
+#define DISPLAY_CHUNK 256
+#define STATUS_BUSY -100
+
+// Termin wysyłania zapytania przez klienta (ms), nadpisywany zmienną środowiskową
+#define SEND_TIMEOUT_MS 2000
+#define SEND_TIMEOUT_ENV "SCHEDULER_SEND_TIMEOUT"
+#define SEND_BACKOFF_MS 10
+#define SEND_BACKOFF_MAX_MS 500
 
 enum command_t {
     RELATIVE,
@@ -13,7 +54,43 @@ enum command_t {
     PERIODIC,
     DISPLAY,
     CANCEL,
-    SHUTDOWN
+    SHUTDOWN,
+    NEGOTIATE,
+    IMPORT,
+    DEPENDENT,
+    PAUSE,
+    RESUME,
+    HANDOVER
+};
+
+// Sposób wskazania zadań w CANCEL/PAUSE/RESUME
+enum selector_t {
+    BY_ID,
+    BY_TAG,
+    BY_NAME
+};
+
+// Stan wstrzymania zadania
+enum pause_state_t {
+    NOT_PAUSED,
+    PAUSED,
+    PAUSED_DUE
+};
+
+// Warunek uruchomienia zadania zależnego
+enum trigger_t {
+    ON_SUCCESS,
+    ON_FAILURE,
+    ON_COMPLETION
+};
+
+// Limity zasobów zadania (0 - brak limitu)
+struct task_limits_t{
+    int timeout;
+    int cpu_seconds;
+    int address_space_mb;
+    int open_files;
+    int nice_level;
 };
 
 // Zapytanie do serwera
@@ -27,6 +104,18 @@ struct query_t{
     int hours;
     int minutes;
     int seconds;
+    int reply_slot;
+    // 1 - zapytanie bez odpowiedzi; odrzucenie zliczane w slocie reply_slot
+    int posted;
+    int client_pid;
+    uid_t client_uid;
+    enum trigger_t trigger;
+    int dependencies[MAX_DEPENDENCIES];
+    int dependency_count;
+    struct task_limits_t limits;
+    enum selector_t selector;
+    char tags[MAX_TAGS][TAG_LENGTH];
+    int tag_count;
 };
 
 // Odpowiedź serwera
@@ -40,10 +129,74 @@ struct task_t{
     enum command_t command;
     int task_id;
     char exec_file_name[256];
-    timer_t timer;
     time_t execution_time;
+    time_t interval;
     int is_active;
     char arguments[256];
+    enum trigger_t trigger;
+    int upstreams[MAX_DEPENDENCIES];
+    int upstream_count;
+    int *dependents;
+    int dependents_count;
+    int dependents_capacity;
+    int running;
+    struct task_limits_t limits;
+    char tags[MAX_TAGS][TAG_LENGTH];
+    int tag_count;
+    enum pause_state_t is_paused;
+};
+
+// Uruchomiona instancja zadania
+struct instance_t{
+    pid_t pid;
+    int pidfd;
+    int task_id;
+    // Limity, o które prosiło zadanie - bit (kod LIMIT_EXIT_* - LIMIT_EXIT_CPU)
+    int limit_mask;
+    unsigned long sequence;
+};
+
+// Statystyki harmonogramu
+struct scheduler_stats_t{
+    long launched;
+    long failed;
+    long timeouts;
+    long kills;
+    long rejected;
+};
+
+// Licznik zapytań klienta w bieżącym oknie limitu
+struct client_rate_t{
+    uid_t uid;
+    pid_t last_pid;
+    time_t window;
+    int count;
+};
+
+// Nagłówek stanu przekazywanego przez HANDOVER; dalej tablice zadań, kopca,
+// instancji i lista identyfikatorów zadań zależnych
+struct handover_header_t{
+    // Pola identyfikujące format na początku - niezależnie od wersji
+    unsigned int magic;
+    unsigned int version;
+    unsigned int header_size;
+    unsigned int task_size;
+    unsigned int deadline_size;
+    unsigned int instance_size;
+    int next_id;
+    unsigned long next_instance;
+    int task_count;
+    int heap_count;
+    int instance_count;
+    long dependents_total;
+    struct scheduler_stats_t stats;
+};
+
+// Lista uruchomionych instancji
+struct instance_list_t{
+    struct instance_t *instances;
+    int size;
+    int capacity;
 };
 
 // Lista zadań
@@ -53,18 +206,73 @@ struct task_list_t{
     int capacity;
 };
 
+// Sesja klienta - pierścień w pamięci współdzielonej lub kolejka komunikatów
+struct shm_ring_t;
+struct client_session_t{
+    struct shm_ring_t *ring;
+    int reply_slot;
+    struct timespec deadline;
+};
+
 int is_server_working();
-int scheduler_server();
+int scheduler_server(const char *import_path);
+int scheduler_server_init();
+int scheduler_server_resume(int state_fd, int queue_fd, const char *fallback);
+int scheduler_validate_resume(int state_fd, int queue_fd);
+int scheduler_server_run(mqd_t queue_id);
 int scheduler_client(int argc, char **argv);
+int scheduler_batch(FILE *input);
 int scheduler_add_task(struct query_t *query);
+int scheduler_import_tasks(const char *path, int capped);
+void scheduler_fill_task(struct task_t *task, struct query_t *query, time_t cur_time);
+pid_t scheduler_execute_task(struct task_t *task);
+void scheduler_dispatch(union sigval value);
+int scheduler_arm_dispatcher();
+int scheduler_schedule(struct deadline_t *entry);
+void scheduler_enforce_timeout(struct deadline_t *entry);
+void scheduler_dump(FILE *dump_file);
+int scheduler_find_task(int task_id);
+void scheduler_remove_task(int index);
+int scheduler_remove_marked(char *marked);
+void scheduler_compact_heap();
+int scheduler_select_tasks(struct query_t *query, char *marked);
+int scheduler_bulk_update(struct query_t *query);
+int scheduler_index_tags(struct task_t *task);
+int scheduler_retire_task(int index, char *marked);
+int scheduler_add_dependent(struct query_t *query);
+void *scheduler_reaper(void *arg);
 void scheduler_display_tasks(struct query_t *query);
-int scheduler_cancel_task(int task_id);
 void scheduler_shutdown(mqd_t queue_id);
+void scheduler_handover(mqd_t queue_id, struct query_t *query);
+void scheduler_handover_signature(char *signature, size_t size);
+int scheduler_handover_check(const char *signature);
+int scheduler_save_state(int fd);
+int scheduler_restore_state(int fd);
+void scheduler_process_query(struct query_t *query);
+void scheduler_negotiate(struct query_t *query);
+int scheduler_validate_query(struct query_t *query);
+int scheduler_admit(struct query_t *query);
+void scheduler_reply_status(struct query_t *query, int status);
+void *scheduler_ring_worker(void *arg);
+int scheduler_send_reply(struct query_t *query, mqd_t reply_queue, struct reply_t *reply);
+int scheduler_mq_request(struct query_t *query, const struct timespec *deadline);
+int scheduler_backoff(const struct timespec *deadline, int *backoff_ms);
+
+int scheduler_session_open(struct client_session_t *session);
+void scheduler_session_deadline(struct client_session_t *session);
+int scheduler_session_request(struct client_session_t *session, struct query_t *query);
+int scheduler_session_retry(struct client_session_t *session, struct query_t *query);
+int scheduler_session_post(struct client_session_t *session, struct query_t *query);
+int scheduler_session_rejected(struct client_session_t *session);
+void scheduler_session_close(struct client_session_t *session);
 
 int handle_program_arguments(int argc, char** argv, struct query_t *query);
+int handle_task_options(int *argc, char** argv, struct query_t *query);
+int handle_selector(int argc, char** argv, struct query_t *query);
 
 int init_task_list(struct task_list_t *list);
 int expand_task_list(struct task_list_t *list);
+int reserve_task_list(struct task_list_t *list, int capacity);
 void free_task_list(struct task_list_t *list);
 
 #endif
@@ -0,0 +1,439 @@
+#include "shm_ring.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define RING_MASK (RING_CAPACITY - 1)
+
+// Oczekiwanie na zmianę słowa futex (pamięć współdzielona między procesami)
+static int futex_wait(atomic_uint *word, unsigned int expected, const struct timespec *timeout) {
+    return syscall(SYS_futex, (unsigned int *)word, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+// Wybudzenie procesów czekających na słowie futex
+static int futex_wake(atomic_uint *word, int count) {
+    return syscall(SYS_futex, (unsigned int *)word, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+// Liczba obrotów aktywnego oczekiwania przed uśpieniem na futexie; na jednym
+// procesorze oczekiwanie aktywne tylko opóźnia drugą stronę
+static int ring_spin_limit() {
+    static int limit = -1;
+    if (limit < 0) {
+        limit = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? RING_SPIN_COUNT : 0;
+    }
+    return limit;
+}
+
+static inline void ring_cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Utworzenie pierścienia przez serwer
+struct shm_ring_t *shm_ring_create() {
+    shm_unlink(RING_NAME);
+    int fd = shm_open(RING_NAME, O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd == -1) {
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(struct shm_ring_t)) != 0) {
+        close(fd);
+        shm_unlink(RING_NAME);
+        return NULL;
+    }
+    struct shm_ring_t *ring = mmap(NULL, sizeof(struct shm_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        shm_unlink(RING_NAME);
+        return NULL;
+    }
+
+    ring->server_pid = getpid();
+    atomic_init(&ring->closed, 0);
+    atomic_init(&ring->interrupted, 0);
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->data_futex, 0);
+    atomic_init(&ring->space_futex, 0);
+    atomic_init(&ring->consumer_waiting, 0);
+    atomic_init(&ring->producers_waiting, 0);
+    for (unsigned long i = 0; i < RING_CAPACITY; i++) {
+        atomic_init(&ring->cells[i].sequence, i);
+        atomic_init(&ring->cells[i].writer, 0);
+    }
+    for (int i = 0; i < RING_REPLY_SLOTS; i++) {
+        atomic_init(&ring->reply_slots[i].owner, 0);
+        atomic_init(&ring->reply_slots[i].state, SLOT_EMPTY);
+    }
+    // Magia zapisana na końcu - klient nie użyje niezainicjalizowanego pierścienia
+    atomic_thread_fence(memory_order_release);
+    ring->magic = RING_MAGIC;
+    return ring;
+}
+
+// Podłączenie klienta do istniejącego pierścienia
+struct shm_ring_t *shm_ring_attach() {
+    int fd = shm_open(RING_NAME, O_RDWR, 0);
+    if (fd == -1) {
+        return NULL;
+    }
+    struct shm_ring_t *ring = mmap(NULL, sizeof(struct shm_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        return NULL;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    if (ring->magic != RING_MAGIC || atomic_load(&ring->closed)) {
+        munmap(ring, sizeof(struct shm_ring_t));
+        return NULL;
+    }
+    return ring;
+}
+
+// Przejęcie istniejącego pierścienia przez serwer po przekazaniu pracy (HANDOVER);
+// zapytania oczekujące w pierścieniu są obsługiwane dalej
+struct shm_ring_t *shm_ring_resume() {
+    struct shm_ring_t *ring = shm_ring_attach();
+    if (ring == NULL) {
+        return NULL;
+    }
+    // Pierścień należący do innego działającego serwera nie jest przejmowany
+    pid_t owner = ring->server_pid;
+    if (owner != getpid() && owner > 0 && (kill(owner, 0) == 0 || errno == EPERM)) {
+        shm_ring_detach(ring);
+        return NULL;
+    }
+    ring->server_pid = getpid();
+    atomic_store(&ring->interrupted, 0);
+    return ring;
+}
+
+// Odłączenie od pierścienia
+void shm_ring_detach(struct shm_ring_t *ring) {
+    if (ring == NULL) {
+        return;
+    }
+    munmap(ring, sizeof(struct shm_ring_t));
+}
+
+// Zamknięcie pierścienia - wybudzenie konsumenta i producentów
+void shm_ring_close(struct shm_ring_t *ring) {
+    if (ring == NULL) {
+        return;
+    }
+    atomic_store(&ring->closed, 1);
+    atomic_fetch_add(&ring->data_futex, 1);
+    atomic_fetch_add(&ring->space_futex, 1);
+    futex_wake(&ring->data_futex, 1);
+    futex_wake(&ring->space_futex, 1 << 30);
+    for (int i = 0; i < RING_REPLY_SLOTS; i++) {
+        futex_wake(&ring->reply_slots[i].state, 1 << 30);
+    }
+}
+
+// Przerwanie oczekiwania konsumenta bez zamykania pierścienia dla klientów
+void shm_ring_interrupt(struct shm_ring_t *ring) {
+    if (ring == NULL) {
+        return;
+    }
+    atomic_store(&ring->interrupted, 1);
+    atomic_fetch_add(&ring->data_futex, 1);
+    futex_wake(&ring->data_futex, 1);
+}
+
+// Usunięcie pierścienia przez serwer
+void shm_ring_destroy(struct shm_ring_t *ring) {
+    if (ring == NULL) {
+        return;
+    }
+    shm_unlink(RING_NAME);
+    munmap(ring, sizeof(struct shm_ring_t));
+}
+
+// Czas pozostały do terminu (CLOCK_REALTIME) jako względny limit futex; -1 gdy termin minął
+static int ring_remaining(const struct timespec *deadline, struct timespec *timeout) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    timeout->tv_sec = deadline->tv_sec - now.tv_sec;
+    timeout->tv_nsec = deadline->tv_nsec - now.tv_nsec;
+    if (timeout->tv_nsec < 0) {
+        timeout->tv_sec--;
+        timeout->tv_nsec += 1000000000L;
+    }
+    return timeout->tv_sec < 0 ? -1 : 0;
+}
+
+// Limit pojedynczego oczekiwania na slot odpowiedzi - krótszy z RING_REPLY_TIMEOUT i czasu do terminu
+static int ring_reply_wait(const struct timespec *deadline, struct timespec *timeout) {
+    struct timespec remaining;
+    timeout->tv_sec = RING_REPLY_TIMEOUT;
+    timeout->tv_nsec = 0;
+    if (deadline == NULL) {
+        return 0;
+    }
+    if (ring_remaining(deadline, &remaining) != 0) {
+        return -1;
+    }
+    if (remaining.tv_sec < RING_REPLY_TIMEOUT) {
+        *timeout = remaining;
+    }
+    return 0;
+}
+
+// Wstawienie zapytania (wielu producentów); deadline (CLOCK_REALTIME, opcjonalny)
+// ogranicza oczekiwanie na wolną komórkę; -2 - termin minął, -3 - komórka uznana za porzuconą
+int shm_ring_push(struct shm_ring_t *ring, const struct query_t *query, const struct timespec *deadline) {
+    unsigned long pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    struct ring_cell_t *cell;
+    while (1) {
+        if (atomic_load(&ring->closed)) {
+            return -1;
+        }
+        cell = &ring->cells[pos & RING_MASK];
+        unsigned long sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        long diff = (long)sequence - (long)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak(&ring->head, &pos, pos + 1)) {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            // Pierścień pełny - czekanie aż serwer zwolni komórkę
+            atomic_fetch_add(&ring->producers_waiting, 1);
+            unsigned int space = atomic_load(&ring->space_futex);
+            sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+            if ((long)sequence - (long)pos < 0 && !atomic_load(&ring->closed)) {
+                if (deadline == NULL) {
+                    futex_wait(&ring->space_futex, space, NULL);
+                } else {
+                    struct timespec timeout;
+                    if (ring_remaining(deadline, &timeout) != 0) {
+                        atomic_fetch_sub(&ring->producers_waiting, 1);
+                        return -2;
+                    }
+                    futex_wait(&ring->space_futex, space, &timeout);
+                }
+            }
+            atomic_fetch_sub(&ring->producers_waiting, 1);
+            pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+        else {
+            pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+
+    // Komórka oznaczana jako zapisywana; porażka oznacza, że serwer uznał ją za porzuconą.
+    // Producent publikuje PID dopiero po przejęciu komórki - spóźniony producent z poprzedniego
+    // okrążenia nie nadpisze PID właściciela
+    unsigned long expected = pos;
+    if (!atomic_compare_exchange_strong(&cell->sequence, &expected, pos | RING_WRITING)) {
+        return -3;
+    }
+    atomic_store(&cell->writer, ((unsigned long)getpid() << 32) | (pos & 0xffffffffUL));
+    memcpy(&cell->query, query, sizeof(struct query_t));
+    expected = pos | RING_WRITING;
+    if (!atomic_compare_exchange_strong_explicit(&cell->sequence, &expected, pos + 1, memory_order_release,
+                                                 memory_order_relaxed)) {
+        return -3;
+    }
+
+    // Budzi tylko pierwszy producent po uśpieniu konsumenta
+    atomic_fetch_add(&ring->data_futex, 1);
+    if (atomic_load(&ring->consumer_waiting) && atomic_exchange(&ring->consumer_waiting, 0)) {
+        futex_wake(&ring->data_futex, 1);
+    }
+    return 0;
+}
+
+// Liczba zapytań oczekujących w pierścieniu (przybliżona)
+unsigned long shm_ring_depth(struct shm_ring_t *ring) {
+    unsigned long head = atomic_load(&ring->head);
+    unsigned long tail = atomic_load(&ring->tail);
+    return head > tail ? head - tail : 0;
+}
+
+// Zwolnienie komórki bez odczytu i przesunięcie ogona (wywoływane przez konsumenta)
+static void ring_release_cell(struct shm_ring_t *ring, struct ring_cell_t *cell, unsigned long pos) {
+    atomic_store_explicit(&cell->sequence, pos + RING_CAPACITY, memory_order_release);
+    atomic_store_explicit(&ring->tail, pos + 1, memory_order_relaxed);
+    atomic_fetch_add(&ring->space_futex, 1);
+    if (atomic_load(&ring->producers_waiting) > 0) {
+        futex_wake(&ring->space_futex, 1 << 30);
+    }
+}
+
+// Pominięcie komórki zarezerwowanej przez producenta, który nie dokończył zapisu:
+// rezerwacja bez zapisu trwająca RING_ABANDON_TIMEOUT lub zapis przerwany śmiercią procesu;
+// PID zapisany dla innej pozycji oznacza producenta, który zginął tuż po przejęciu komórki
+static int ring_skip_abandoned(struct ring_cell_t *cell, unsigned long pos, unsigned long sequence) {
+    unsigned long expected = sequence;
+    if (sequence == pos) {
+        return atomic_compare_exchange_strong(&cell->sequence, &expected, pos + RING_CAPACITY);
+    }
+    if (sequence != (pos | RING_WRITING)) {
+        return 0;
+    }
+    unsigned long writer = atomic_load(&cell->writer);
+    pid_t pid = (pid_t)(writer >> 32);
+    if ((writer & 0xffffffffUL) != (pos & 0xffffffffUL) || (kill(pid, 0) == -1 && errno == ESRCH)) {
+        return atomic_compare_exchange_strong(&cell->sequence, &expected, pos + RING_CAPACITY);
+    }
+    return 0;
+}
+
+// Pobranie zapytania (jeden konsument - serwer); blokuje gdy pierścień pusty
+int shm_ring_pop(struct shm_ring_t *ring, struct query_t *query) {
+    unsigned long pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    struct ring_cell_t *cell = &ring->cells[pos & RING_MASK];
+    time_t stalled_since = 0;
+    while (1) {
+        if (atomic_load(&ring->interrupted)) {
+            return -2;
+        }
+        // Krótkie oczekiwanie aktywne - przy ciągłym napływie zapytań bez wywołań systemowych
+        unsigned long sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        for (int spin = 0; spin < ring_spin_limit() && sequence != pos + 1; spin++) {
+            ring_cpu_relax();
+            sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        }
+        if (sequence == pos + 1) {
+            break;
+        }
+        if (atomic_load(&ring->closed)) {
+            return -1;
+        }
+        // Komórka zarezerwowana (head za nią), ale nieopublikowana
+        struct timespec timeout = { RING_ABANDON_TIMEOUT, 0 };
+        struct timespec *wait = NULL;
+        if (atomic_load(&ring->head) > pos) {
+            time_t now = time(NULL);
+            if (stalled_since == 0) {
+                stalled_since = now;
+            }
+            else if (now - stalled_since >= RING_ABANDON_TIMEOUT && ring_skip_abandoned(cell, pos, sequence)) {
+                ring_release_cell(ring, cell, pos);
+                pos++;
+                cell = &ring->cells[pos & RING_MASK];
+                stalled_since = 0;
+                continue;
+            }
+            wait = &timeout;
+        }
+        atomic_store(&ring->consumer_waiting, 1);
+        unsigned int data = atomic_load(&ring->data_futex);
+        sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        if (sequence != pos + 1 && !atomic_load(&ring->closed) && !atomic_load(&ring->interrupted)) {
+            futex_wait(&ring->data_futex, data, wait);
+        }
+        atomic_store(&ring->consumer_waiting, 0);
+    }
+
+    memcpy(query, &cell->query, sizeof(struct query_t));
+    ring_release_cell(ring, cell, pos);
+    return 0;
+}
+
+// Przydzielenie slotu odpowiedzi; sloty martwych klientów są odzyskiwane
+int shm_ring_acquire_slot(struct shm_ring_t *ring, pid_t owner) {
+    for (int i = 0; i < RING_REPLY_SLOTS; i++) {
+        struct ring_reply_slot_t *slot = &ring->reply_slots[i];
+        int current = atomic_load(&slot->owner);
+        if (current != 0 && kill(current, 0) == -1 && errno == ESRCH) {
+            atomic_compare_exchange_strong(&slot->owner, &current, 0);
+            current = 0;
+        }
+        if (current == 0) {
+            int expected = 0;
+            if (atomic_compare_exchange_strong(&slot->owner, &expected, owner)) {
+                atomic_store(&slot->state, SLOT_EMPTY);
+                atomic_store(&slot->rejected, 0);
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+// Zwolnienie slotu odpowiedzi przez klienta
+void shm_ring_release_slot(struct shm_ring_t *ring, int slot) {
+    if (slot < 0 || slot >= RING_REPLY_SLOTS) {
+        return;
+    }
+    atomic_store(&ring->reply_slots[slot].state, SLOT_EMPTY);
+    atomic_store(&ring->reply_slots[slot].owner, 0);
+}
+
+// Zapis odpowiedzi do slotu klienta (serwer); deadline (CLOCK_REALTIME, opcjonalny) ogranicza
+// oczekiwanie na odebranie poprzedniej odpowiedzi; -3 - termin minął
+int shm_ring_reply(struct shm_ring_t *ring, int slot, const struct reply_t *reply, const struct timespec *deadline) {
+    if (slot < 0 || slot >= RING_REPLY_SLOTS) {
+        return -1;
+    }
+    struct ring_reply_slot_t *reply_slot = &ring->reply_slots[slot];
+    struct timespec timeout;
+    // Poprzednia odpowiedź musi zostać odebrana; klient mógł się zakończyć
+    while (atomic_load(&reply_slot->state) == SLOT_READY) {
+        int owner = atomic_load(&reply_slot->owner);
+        if (owner == 0 || (kill(owner, 0) == -1 && errno == ESRCH)) {
+            return -2;
+        }
+        if (ring_reply_wait(deadline, &timeout) != 0) {
+            return -3;
+        }
+        futex_wait(&reply_slot->state, SLOT_READY, &timeout);
+    }
+    memcpy(&reply_slot->reply, reply, sizeof(struct reply_t));
+    atomic_store(&reply_slot->state, SLOT_READY);
+    futex_wake(&reply_slot->state, 1);
+    return 0;
+}
+
+// Odbiór odpowiedzi ze slotu (klient); -3 - termin minął
+int shm_ring_receive(struct shm_ring_t *ring, int slot, struct reply_t *reply, const struct timespec *deadline) {
+    if (slot < 0 || slot >= RING_REPLY_SLOTS) {
+        return -1;
+    }
+    struct ring_reply_slot_t *reply_slot = &ring->reply_slots[slot];
+    struct timespec timeout;
+    for (int spin = 0; spin < ring_spin_limit() && atomic_load(&reply_slot->state) != SLOT_READY; spin++) {
+        ring_cpu_relax();
+    }
+    while (atomic_load(&reply_slot->state) != SLOT_READY) {
+        if (atomic_load(&ring->closed) || (kill(ring->server_pid, 0) == -1 && errno == ESRCH)) {
+            return -2;
+        }
+        if (ring_reply_wait(deadline, &timeout) != 0) {
+            return -3;
+        }
+        futex_wait(&reply_slot->state, SLOT_EMPTY, &timeout);
+    }
+    memcpy(reply, &reply_slot->reply, sizeof(struct reply_t));
+    atomic_store(&reply_slot->state, SLOT_EMPTY);
+    futex_wake(&reply_slot->state, 1);
+    return 0;
+}
+
+// Zliczenie odrzuconego zapytania wysłanego bez oczekiwania na odpowiedź (serwer)
+void shm_ring_count_rejected(struct shm_ring_t *ring, int slot) {
+    if (slot < 0 || slot >= RING_REPLY_SLOTS) {
+        return;
+    }
+    atomic_fetch_add(&ring->reply_slots[slot].rejected, 1);
+}
+
+// Odczyt i wyzerowanie liczby odrzuconych zapytań slotu (klient)
+int shm_ring_take_rejected(struct shm_ring_t *ring, int slot) {
+    if (slot < 0 || slot >= RING_REPLY_SLOTS) {
+        return 0;
+    }
+    return atomic_exchange(&ring->reply_slots[slot].rejected, 0);
+}
@@ -0,0 +1,77 @@
+#ifndef PROJECT2_SHM_RING_H
+#define PROJECT2_SHM_RING_H
+
+#include "scheduler.h"
+#include <stdatomic.h>
+#include <sys/types.h>
+
+#define RING_NAME "/scheduler_shm_ring"
+#define RING_MAGIC 0x53524e47
+#define RING_CAPACITY 1024
+#define RING_REPLY_SLOTS 64
+#define RING_REPLY_TIMEOUT 1
+#define RING_HIGH_WATERMARK (RING_CAPACITY * 3 / 4)
+#define RING_ABANDON_TIMEOUT 1
+#define RING_SPIN_COUNT 20000
+// Znacznik komórki zajętej przez producenta w trakcie zapisu
+#define RING_WRITING (1UL << 62)
+
+// Stan slotu odpowiedzi (słowo futex)
+enum reply_slot_state_t {
+    SLOT_EMPTY,
+    SLOT_READY
+};
+
+// Komórka pierścienia zapytań
+struct ring_cell_t {
+    atomic_ulong sequence;
+    // PID producenta (starsze 32 bity) i młodsze bity pozycji, dla której go zapisano
+    atomic_ulong writer;
+    struct query_t query;
+};
+
+// Slot odpowiedzi przydzielany jednemu klientowi
+struct ring_reply_slot_t {
+    atomic_int owner;
+    atomic_uint state;
+    // Odrzucone zapytania wysłane bez oczekiwania na odpowiedź
+    atomic_int rejected;
+    struct reply_t reply;
+};
+
+// Pierścień MPSC w pamięci współdzielonej
+struct shm_ring_t {
+    unsigned int magic;
+    pid_t server_pid;
+    atomic_int closed;
+    atomic_int interrupted;
+    atomic_ulong head;
+    atomic_ulong tail;
+    atomic_uint data_futex;
+    atomic_uint space_futex;
+    atomic_int consumer_waiting;
+    atomic_int producers_waiting;
+    struct ring_cell_t cells[RING_CAPACITY];
+    struct ring_reply_slot_t reply_slots[RING_REPLY_SLOTS];
+};
+
+struct shm_ring_t *shm_ring_create();
+struct shm_ring_t *shm_ring_attach();
+struct shm_ring_t *shm_ring_resume();
+void shm_ring_detach(struct shm_ring_t *ring);
+void shm_ring_close(struct shm_ring_t *ring);
+void shm_ring_interrupt(struct shm_ring_t *ring);
+void shm_ring_destroy(struct shm_ring_t *ring);
+
+int shm_ring_push(struct shm_ring_t *ring, const struct query_t *query, const struct timespec *deadline);
+unsigned long shm_ring_depth(struct shm_ring_t *ring);
+int shm_ring_pop(struct shm_ring_t *ring, struct query_t *query);
+
+int shm_ring_acquire_slot(struct shm_ring_t *ring, pid_t owner);
+void shm_ring_release_slot(struct shm_ring_t *ring, int slot);
+int shm_ring_reply(struct shm_ring_t *ring, int slot, const struct reply_t *reply, const struct timespec *deadline);
+int shm_ring_receive(struct shm_ring_t *ring, int slot, struct reply_t *reply, const struct timespec *deadline);
+void shm_ring_count_rejected(struct shm_ring_t *ring, int slot);
+int shm_ring_take_rejected(struct shm_ring_t *ring, int slot);
+
+#endif
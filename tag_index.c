@@ -0,0 +1,118 @@
+#include "tag_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Funkcja mieszająca FNV-1a
+static unsigned int tag_hash(const char *tag) {
+    unsigned int hash = 2166136261u;
+    for (; *tag != '\0'; tag++) {
+        hash ^= (unsigned char)*tag;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Wyszukanie komórki dla tagu - zajętej tym tagiem lub pierwszej wolnej
+static struct tag_entry_t *tag_index_slot(struct tag_entry_t *entries, int capacity, const char *tag) {
+    unsigned int position = tag_hash(tag) & (capacity - 1);
+    while (entries[position].tag[0] != '\0' && strcmp(entries[position].tag, tag) != 0) {
+        position = (position + 1) & (capacity - 1);
+    }
+    return &entries[position];
+}
+
+// Podwojenie tablicy mieszającej
+static int tag_index_expand(struct tag_index_t *index) {
+    int capacity = index->capacity * 2;
+    struct tag_entry_t *entries = calloc(capacity, sizeof(struct tag_entry_t));
+    if (entries == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < index->capacity; i++) {
+        if (index->entries[i].tag[0] != '\0') {
+            *tag_index_slot(entries, capacity, index->entries[i].tag) = index->entries[i];
+        }
+    }
+    free(index->entries);
+    index->entries = entries;
+    index->capacity = capacity;
+    return 0;
+}
+
+// Inicjalizacja indeksu
+int init_tag_index(struct tag_index_t *index) {
+    if (index == NULL) {
+        return -1;
+    }
+    index->size = 0;
+    index->capacity = TAG_INDEX_CAPACITY;
+    index->entries = calloc(index->capacity, sizeof(struct tag_entry_t));
+    if (index->entries == NULL) {
+        return -2;
+    }
+    return 0;
+}
+
+// Zwalnianie pamięci indeksu
+void free_tag_index(struct tag_index_t *index) {
+    if (index == NULL || index->entries == NULL) {
+        return;
+    }
+    for (int i = 0; i < index->capacity; i++) {
+        free(index->entries[i].task_ids);
+    }
+    free(index->entries);
+    index->entries = NULL;
+    index->size = 0;
+    index->capacity = 0;
+}
+
+// Dodanie zadania do listy tagu
+int tag_index_add(struct tag_index_t *index, const char *tag, int task_id) {
+    if (tag[0] == '\0' || strlen(tag) >= TAG_LENGTH) {
+        return -1;
+    }
+    // Współczynnik wypełnienia poniżej 1/2; wpisy tagów nie są usuwane z tablicy
+    if (2 * (index->size + 1) > index->capacity && tag_index_expand(index) != 0) {
+        return -2;
+    }
+    struct tag_entry_t *entry = tag_index_slot(index->entries, index->capacity, tag);
+    if (entry->tag[0] == '\0') {
+        strcpy(entry->tag, tag);
+        index->size++;
+    }
+    if (entry->size >= entry->capacity) {
+        int capacity = entry->capacity > 0 ? entry->capacity * 2 : 8;
+        int *task_ids = realloc(entry->task_ids, capacity * sizeof(int));
+        if (task_ids == NULL) {
+            return -2;
+        }
+        entry->task_ids = task_ids;
+        entry->capacity = capacity;
+    }
+    entry->task_ids[entry->size++] = task_id;
+    return 0;
+}
+
+// Pozostawienie na liście tagu tylko zadań przyjętych przez funkcję keep - jedno przejście, kolejność zachowana
+void tag_index_retain(struct tag_entry_t *entry, int (*keep)(int task_id, void *context), void *context) {
+    int size = 0;
+    for (int i = 0; i < entry->size; i++) {
+        if (keep(entry->task_ids[i], context)) {
+            entry->task_ids[size++] = entry->task_ids[i];
+        }
+    }
+    entry->size = size;
+}
+
+// Wyszukanie listy zadań dla tagu
+struct tag_entry_t *tag_index_find(struct tag_index_t *index, const char *tag) {
+    if (tag[0] == '\0') {
+        return NULL;
+    }
+    struct tag_entry_t *entry = tag_index_slot(index->entries, index->capacity, tag);
+    if (entry->tag[0] == '\0') {
+        return NULL;
+    }
+    return entry;
+}
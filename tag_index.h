@@ -0,0 +1,29 @@
+#ifndef PROJECT2_TAG_INDEX_H
+#define PROJECT2_TAG_INDEX_H
+
+#define TAG_LENGTH 32
+#define TAG_INDEX_CAPACITY 64
+
+// Lista zadań oznaczonych jednym tagiem
+struct tag_entry_t{
+    char tag[TAG_LENGTH];
+    int *task_ids;
+    int size;
+    int capacity;
+};
+
+// Indeks odwrotny tag -> identyfikatory zadań (tablica mieszająca z adresowaniem otwartym)
+struct tag_index_t{
+    struct tag_entry_t *entries;
+    int size;
+    int capacity;
+};
+
+int init_tag_index(struct tag_index_t *index);
+void free_tag_index(struct tag_index_t *index);
+
+int tag_index_add(struct tag_index_t *index, const char *tag, int task_id);
+void tag_index_retain(struct tag_entry_t *entry, int (*keep)(int task_id, void *context), void *context);
+struct tag_entry_t *tag_index_find(struct tag_index_t *index, const char *tag);
+
+#endif